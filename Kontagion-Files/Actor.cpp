@@ -1,6 +1,7 @@
 #include "Actor.h"
 #include "StudentWorld.h"
 #include "GameConstants.h"
+#include "FixedPoint.h"
 #include <cmath>
 #include <algorithm>
 
@@ -8,10 +9,22 @@
 //Actor Functions
 
 Actor::Actor(int imageID, double startX, double startY, int startDirection, int depth, StudentWorld* sw)
-	: GraphObject(imageID, startX, startY, startDirection, depth)
+	: GraphObject(sw->graphObjects(), imageID, startX, startY, startDirection, depth)
 {
 	m_alive = true;		//start actors as alive in a studentworld
 	m_world = sw;
+	m_random = sw->spawnStream();	//own random stream, split from whoever spawned this actor
+	m_worldOrder = 0;
+}
+
+void* Actor::operator new(std::size_t size)
+{
+	return ActorPool::local().allocate(size);
+}
+
+void Actor::operator delete(void* p, std::size_t size)
+{
+	ActorPool::local().deallocate(p, size);
 }
 
 bool Actor::isAlive() const
@@ -19,15 +32,25 @@ bool Actor::isAlive() const
 	return m_alive;
 }
 
+void Actor::planTick()
+{}
+
+void Actor::commitTick()
+{
+	doSomething();
+}
+
 void Actor::setDead()
 {
+	if (m_alive)
+		m_world->actorDied(this);	//lets the sweep skip lists nothing died in
 	m_alive = false;
 }
 
 bool Actor::doesOverLap(double x, double y, double distance) const
 {
-	double dist = sqrt((getX() - x) * (getX() - x) + (getY() - y) * (getY() - y));	//get distance between object and specified x and y
-	if (dist <= distance)
+	double dist2 = (getX() - x) * (getX() - x) + (getY() - y) * (getY() - y);	//get squared distance between object and specified x and y
+	if (dist2 <= distance * distance)
 		return true;
 	else
 		return false;
@@ -38,11 +61,39 @@ bool Actor::isDamageable() const
 	return true;
 }
 
+bool Actor::actsEachTick() const
+{
+	return true;
+}
+
 StudentWorld* Actor::giveWorld() const
 {
 	return m_world;
 }
 
+RandomStream& Actor::random()
+{
+	return m_random;
+}
+
+unsigned long long Actor::worldOrder() const
+{
+	return m_worldOrder;
+}
+
+void Actor::setWorldOrder(unsigned long long order)
+{
+	m_worldOrder = order;
+}
+
+void Actor::moveTo(double x, double y)
+{
+	double oldX = getX();
+	double oldY = getY();
+	GraphObject::moveTo(x, y);
+	m_world->actorMoved(this, oldX, oldY);	//keep the world's spatial grid in sync
+}
+
 bool Actor::canOverLap() const
 {
 	return false;
@@ -103,14 +154,21 @@ Socrates::Socrates(StudentWorld* sw)
 {
 	m_sprayCharges = 20;
 	m_flameCharges = 5;
+	m_positionAngle = 180;	//socrates starts on the left edge
 }
 
- void Socrates::socratesMoveTo(double angle)
+ActorType Socrates::type() const
 {
-	 double oldTheta = atan2((getY()-VIEW_RADIUS), (getX() - VIEW_RADIUS));		//calculate Socrate's positional angle
-	 double theta = oldTheta + (angle * (PI / 180));			//calculate positional angle after move
-	 moveTo(VIEW_RADIUS * cos(theta) + VIEW_RADIUS, VIEW_RADIUS * sin(theta) + VIEW_RADIUS);	//move Socrates to new angle
-	 setDirection((theta * 180 / PI) + 180);	//adjust direction to face center of circle
+	return ACTOR_SOCRATES;
+}
+
+ void Socrates::socratesMoveTo(int angle)
+{
+	 m_positionAngle = (m_positionAngle + angle + 360) % 360;		//calculate positional angle after move
+	 double dx, dy;
+	 polarOffset(m_positionAngle, VIEW_RADIUS, dx, dy);
+	 moveTo(dx + VIEW_RADIUS, dy + VIEW_RADIUS);	//move Socrates to new angle
+	 setDirection(m_positionAngle + 180);	//adjust direction to face center of circle
 }
 
  void Socrates::addFlame()
@@ -153,7 +211,7 @@ void Socrates::doSomething()
 				giveWorld()->playSound(SOUND_PLAYER_SPRAY);
 				double newX, newY;
 				getPositionInThisDirection(getDirection(), SPRITE_WIDTH, newX, newY);		//spawn the spray one sprite_width in front of socrates
-				giveWorld()->addActor(new Spray(giveWorld(), newX, newY, getDirection()));
+				giveWorld()->launchProjectile(ProjectileSystem::SPRAY, newX, newY, getDirection());
 				m_sprayCharges--;
 			}
 			break;
@@ -170,7 +228,7 @@ void Socrates::doSomething()
 						dir += (i * 22);
 					double newX, newY;
 					getPositionInThisDirection(dir, SPRITE_WIDTH, newX, newY);
-					giveWorld()->addActor(new Flame(giveWorld(), newX, newY, dir));
+					giveWorld()->launchProjectile(ProjectileSystem::FLAME, newX, newY, dir);
 				}
 				m_flameCharges--;
 			}
@@ -207,7 +265,14 @@ int Socrates::flameCharges() const
 
 DirtPile::DirtPile(StudentWorld* sw, double startX, double startY)
 	:Actor(IID_DIRT, startX, startY, 0, 1, sw)
-{}
+{
+	makeStatic();	//never moves, so it is drawn from the cached static layer
+}
+
+ActorType DirtPile::type() const
+{
+	return ACTOR_DIRT;
+}
 
 void DirtPile::doSomething()
 {
@@ -224,13 +289,25 @@ bool DirtPile::blocksMovement() const
 	return true;
 }
 
+bool DirtPile::actsEachTick() const
+{
+	return false;
+}
+
 
 
 //Food functions
 
 Food::Food(StudentWorld* sw, double startX, double startY)
 	:Actor(IID_FOOD, startX, startY, 90, 1, sw)
-{}
+{
+	makeStatic();
+}
+
+ActorType Food::type() const
+{
+	return ACTOR_FOOD;
+}
 
 void Food::doSomething()
 {}
@@ -245,6 +322,11 @@ bool Food::isEdible() const
 	return true;
 }
 
+bool Food::actsEachTick() const
+{
+	return false;
+}
+
 
 
 //Pit functions
@@ -252,11 +334,17 @@ bool Food::isEdible() const
 Pit::Pit(StudentWorld* sw, double startX, double startY)
 	:Actor(IID_PIT, startX, startY, 0, 1, sw)
 {
+	makeStatic();
 	m_salmonella = 5;
 	m_aggressiveSalmonella = 3;
 	m_eColi = 2;
 }
 
+ActorType Pit::type() const
+{
+	return ACTOR_PIT;
+}
+
 void Pit::doSomething()
 {
 	if (m_salmonella <= 0 && m_aggressiveSalmonella <= 0 && m_eColi <= 0)
@@ -264,12 +352,12 @@ void Pit::doSomething()
 		setDead();
 		return;
 	}
-	int chanceBacteria = randInt(0, 49);	//1/50 chance of a new bacterium
+	int chanceBacteria = random().nextInt(0, 49);	//1/50 chance of a new bacterium
 	if (chanceBacteria == 0)
 	{
 		while (true)
 		{
-			int typeBacteria = randInt(0, 2);	//randomly pick an integer 0 - 2, and then try to add a bacterium of the integer
+			int typeBacteria = random().nextInt(0, 2);	//randomly pick an integer 0 - 2, and then try to add a bacterium of the integer
 			if (typeBacteria == 0 && m_salmonella > 0)	//if there are no more of that type, pick another integer
 			{
 				giveWorld()->addActor(new RegularSalmonella(giveWorld(), getX(), getY()));	
@@ -307,62 +395,13 @@ bool Pit::preventsLevelCompleting() const
 
 
 
-//Projectile functions
-
-Projectile::Projectile(StudentWorld* sw, double startX, double startY, double direction, double range, double damage, int image)
-	: Actor(image, startX, startY, direction, 1, sw)
-{
-	m_range = range;	
-	m_damage = damage;
-	m_distance = 0;
-}
-
-void Projectile::doSomething()
-{
-	if (!isAlive())	
-		return;
-	if (giveWorld()->damageObject(getX(), getY(), giveDamage()))	//set projectile dead if it deals damage
-		setDead();
-	moveAngle(getDirection(), SPRITE_WIDTH);	//move in straight direction
-	m_distance += (SPRITE_WIDTH);
-	if (m_distance >= m_range)	//set dead if range is exceeded
-	{
-		setDead();
-		return;
-	}
-}
-
-double Projectile::giveDamage() const
-{
-	return m_damage;
-}
-
-bool Projectile::isDamageable() const
-{
-	return false;
-}
-
-
-
-Spray::Spray(StudentWorld* sw, double startX, double startY, double direction)
-	:Projectile(sw, startX, startY, direction, 112, 2, IID_SPRAY)
-{}
-
-
-
-Flame::Flame(StudentWorld* sw, double startX, double startY, double direction)
-	:Projectile(sw, startX, startY, direction, 32, 5, IID_FLAME)
-{}
-
-
-
 //Goodie Functions
 
 Goodie::Goodie(StudentWorld* sw, double startX, double startY, int image)
 	:Actor(image, startX, startY, 0, 1, sw)
 {
 	m_lifeElapsed = 0;				
-	m_lifeTime = std::max(randInt(0, 300 - 10 * sw->getLevel() - 1), 50);
+	m_lifeTime = std::max(random().nextInt(0, 300 - 10 * sw->getLevel() - 1), 50);
 }
 
 void Goodie::doSomething()
@@ -411,6 +450,11 @@ HealthGoodie::HealthGoodie(StudentWorld* sw, double startX, double startY)
 	:Goodie(sw, startX, startY, IID_RESTORE_HEALTH_GOODIE)
 {}
 
+ActorType HealthGoodie::type() const
+{
+	return ACTOR_HEALTH_GOODIE;
+}
+
 void HealthGoodie::goodieAction(Socrates* s)
 {
 	giveWorld()->increaseScore(250);
@@ -426,6 +470,11 @@ FlameThrowerGoodie::FlameThrowerGoodie(StudentWorld* sw, double startX, double s
 	:Goodie(sw, startX, startY, IID_FLAME_THROWER_GOODIE)
 {}
 
+ActorType FlameThrowerGoodie::type() const
+{
+	return ACTOR_FLAME_THROWER_GOODIE;
+}
+
 void FlameThrowerGoodie::goodieAction(Socrates* s)
 {
 	giveWorld()->increaseScore(300);
@@ -442,6 +491,11 @@ ExtraLifeGoodie::ExtraLifeGoodie(StudentWorld* sw, double startX, double startY)
 	:Goodie(sw, startX, startY, IID_EXTRA_LIFE_GOODIE)
 {}
 
+ActorType ExtraLifeGoodie::type() const
+{
+	return ACTOR_EXTRA_LIFE_GOODIE;
+}
+
 void ExtraLifeGoodie::goodieAction(Socrates* s)
 {
 	giveWorld()->increaseScore(500);
@@ -458,6 +512,11 @@ Fungus::Fungus(StudentWorld* sw, double startX, double startY)
 	:Goodie(sw, startX, startY, IID_FUNGUS)
 {}
 
+ActorType Fungus::type() const
+{
+	return ACTOR_FUNGUS;
+}
+
 void Fungus::goodieAction(Socrates* s)
 {
 	giveWorld()->increaseScore(-50);
@@ -480,27 +539,37 @@ Bacterium::Bacterium(StudentWorld* sw, int image, double startX, double startY,
 
 void Bacterium::doSomething()
 {
+	planTick();
+	commitTick();
+}
+
+void Bacterium::planTick()
+{
+	m_plan = BacteriumPlan();
 	if (health() <= 0)	//if bacteria runs out of health, it dies, increases score, plays it death sound, and checks if it should leave food
 	{
-		playSoundDie();
-		giveWorld()->increaseScore(100);
-		setDead();
-		int chanceFood = randInt(0, 1);
+		m_plan.dies = true;
+		int chanceFood = random().nextInt(0, 1);
 		if (chanceFood == 0)
-			giveWorld()->addActor(new Food(giveWorld(), getX(), getY()));
+		{
+			m_plan.dropsFood = true;
+			reserveSpawn();
+		}
 		return;
 	}
 	bool performedAggressive = aggressiveSalmonellaSpecific();	//aggressive salmonella has a specific action that determines its later behavior
-	if (giveWorld()->giveSocrates()->doesOverLap(getX(), getY(), SPRITE_WIDTH))	//damage socrates if bacteria overlaps with him
+	double x = m_plan.moves ? m_plan.moveX : getX();	//where the aggressive move would leave it
+	double y = m_plan.moves ? m_plan.moveY : getY();
+	if (giveWorld()->giveSocrates()->doesOverLap(x, y, SPRITE_WIDTH))	//damage socrates if bacteria overlaps with him
 	{
-		giveWorld()->giveSocrates()->takeDamage(m_damage);
+		m_plan.socratesDamage = m_damage;
 	}
 	else
 	{
 		if (m_foodEaten == 3)	//multiply if bacteria has eaten 3 food
 		{
-			double newX = getX();
-			double newY = getY();
+			double newX = x;
+			double newY = y;
 
 			if (newX < VIEW_WIDTH / 2)
 				newX += SPRITE_WIDTH / 2;
@@ -511,18 +580,14 @@ void Bacterium::doSomething()
 			else if (newY > VIEW_HEIGHT / 2)
 				newY -= SPRITE_WIDTH / 2;
 
-			multiplyBacteria(newX, newY);
+			m_plan.multiplies = true;
+			m_plan.childX = newX;
+			m_plan.childY = newY;
+			reserveSpawn();
 			m_foodEaten = 0;
 		}
 		else                   //otherwise check if bacteria currently overlaps with food, and if so eat food
-		{
-			Actor* food = giveWorld()->getOverlappingEdible(this);
-			if (food != nullptr)
-			{
-				food->setDead();
-				m_foodEaten++;
-			}
-		}
+			m_plan.food = giveWorld()->getOverlappingEdible(x, y);
 	}
 	if (!performedAggressive)	//perform bacterium specific action, if an aggressive salmonella has performed its specific action, it will not
 		bacteriumSpecific();
@@ -530,6 +595,51 @@ void Bacterium::doSomething()
 
 }
 
+void Bacterium::commitTick()
+{
+	if (m_plan.dies)
+	{
+		playSoundDie();
+		giveWorld()->increaseScore(100);
+		setDead();
+	}
+	if (m_plan.moves)
+	{
+		moveTo(m_plan.moveX, m_plan.moveY);
+		increaseAnimationNumber();
+	}
+	if (m_plan.socratesDamage > 0)
+		giveWorld()->giveSocrates()->takeDamage(m_plan.socratesDamage);
+	if (m_plan.food != nullptr && m_plan.food->isAlive())	//the first bacterium in world order to reach a food gets it
+	{
+		m_plan.food->setDead();
+		m_foodEaten++;
+	}
+	if (m_plan.dropsFood || m_plan.multiplies)
+	{
+		RandomStream* previous = giveWorld()->setSpawnParent(&m_plan.spawnParent);
+		if (m_plan.dropsFood)
+			giveWorld()->addActor(new Food(giveWorld(), getX(), getY()));
+		else
+			multiplyBacteria(m_plan.childX, m_plan.childY);
+		giveWorld()->setSpawnParent(previous);
+	}
+	m_plan = BacteriumPlan();
+}
+
+void Bacterium::reserveSpawn()
+{
+	m_plan.spawnParent = random();
+	random().split();
+}
+
+void Bacterium::planMoveTo(double x, double y)
+{
+	m_plan.moves = true;
+	m_plan.moveX = x;
+	m_plan.moveY = y;
+}
+
 bool Bacterium::preventsLevelCompleting() const
 {
 	return true;
@@ -553,7 +663,7 @@ void Bacterium::decrementMovePlan()
 
 void Bacterium::resetMovePlan()		//find a new location to move
 {
-	int newAngle = randInt(0, 359);
+	int newAngle = random().nextInt(0, 359);
 	setDirection(newAngle);
 	m_movePlanDistance = 10;
 }
@@ -574,7 +684,7 @@ void Salmonella::bacteriumSpecific()
 		getPositionInThisDirection(getDirection(), 3, newX, newY);
 		if (giveWorld()->checkForMovePossible(newX, newY))	//move if possible, pick new direction if not
 		{
-			moveAngle(getDirection(), 3);
+			planMoveTo(newX, newY);
 			return;
 		}
 		else
@@ -593,7 +703,7 @@ void Salmonella::bacteriumSpecific()
 			getPositionInThisDirection(getDirection(), 3, newX, newY);
 			if (giveWorld()->checkForMovePossible(newX, newY) == true)
 			{
-				moveAngle(getDirection(), 3);
+				planMoveTo(newX, newY);
 				return;
 			}
 			else
@@ -631,6 +741,11 @@ RegularSalmonella::RegularSalmonella(StudentWorld* sw, double startX, double sta
 	:Salmonella(sw, startX, startY, 4, 1)
 {}
 
+ActorType RegularSalmonella::type() const
+{
+	return ACTOR_REGULAR_SALMONELLA;
+}
+
 void RegularSalmonella::multiplyBacteria(double x, double y)	
 {
 	giveWorld()->addActor(new RegularSalmonella(giveWorld(), x, y));
@@ -643,6 +758,11 @@ AggressiveSalmonella::AggressiveSalmonella(StudentWorld* sw, double startX, doub
 	:Salmonella(sw, startX, startY, 10, 2)
 {}
 
+ActorType AggressiveSalmonella::type() const
+{
+	return ACTOR_AGGRESSIVE_SALMONELLA;
+}
+
 bool AggressiveSalmonella::aggressiveSalmonellaSpecific()
 {
 	int theta;							//find socrates and try to move towards him if he is range
@@ -651,7 +771,7 @@ bool AggressiveSalmonella::aggressiveSalmonellaSpecific()
 		double newX, newY;
 		getPositionInThisDirection(theta, 3, newX, newY);
 		if (giveWorld()->checkForMovePossible(newX, newY))
-			moveAngle(theta, 3);
+			planMoveTo(newX, newY);
 		return true;
 	}
 	return false;
@@ -668,6 +788,11 @@ Ecoli::Ecoli(StudentWorld* sw, double startX, double startY)
 	:Bacterium(sw, IID_ECOLI, startX, startY, 5, 4)
 {}
 
+ActorType Ecoli::type() const
+{
+	return ACTOR_ECOLI;
+}
+
 void Ecoli::bacteriumSpecific()
 {
 	int theta;
@@ -680,7 +805,7 @@ void Ecoli::bacteriumSpecific()
 			getPositionInThisDirection(getDirection(), 2, newX, newY);
 			if (giveWorld()->checkForMovePossible(newX, newY) == true)
 			{
-				moveAngle(getDirection(), 2);
+				planMoveTo(newX, newY);
 				return;
 			}
 			if ((theta += 10) >= 359)			//wrap around theta if angle exceeds 359
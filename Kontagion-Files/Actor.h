@@ -3,6 +3,8 @@
 
 #include "GraphObject.h"
 #include "StudentWorld.h"
+#include "ActorPool.h"
+#include <cstddef>
 // Students:  Add code to this file, Actor.cpp, StudentWorld.h, and StudentWorld.cpp
 
  const double PI = 3.14159265359;
@@ -11,8 +13,12 @@ class Actor : public GraphObject
 {
 public:
 	Actor(int imageID, double startX, double startY, int startDirection, int depth, StudentWorld* sw);
+	static void* operator new(std::size_t size);		//every actor comes from this thread's ActorPool
+	static void operator delete(void* p, std::size_t size);
 	bool isAlive() const;		//return current life status
 	virtual void doSomething() = 0;		//a plain actor class will never be called to doSomething, this is the action classes take in each turn
+	virtual void planTick();		//default nothing, first half of a two-phase tick, may only change this actor's own state
+	virtual void commitTick();		//default doSomething, second half of a two-phase tick, run in world order
 	void setDead();		//modify status to dead
 	bool doesOverLap(double x, double y, double distance) const;		//check if object's are close enough to be considered overlapping
 	virtual bool canOverLap() const;	//default = false, return if object is allowed to overlap with other objects
@@ -21,7 +27,13 @@ public:
 	virtual void takeDamage(int damage);		//default setsdead
 	virtual bool isEdible() const;
 	virtual bool preventsLevelCompleting() const;
+	virtual bool actsEachTick() const;		//default = true, false for objects whose turn would do nothing, which the world never ticks
+	virtual ActorType type() const = 0;		//concrete kind of actor, for population counts
 	StudentWorld* giveWorld() const;	//accessor to object's world
+	RandomStream& random();		//this actor's private random stream
+	virtual void moveTo(double x, double y);	//move and let the world rebucket the actor
+	unsigned long long worldOrder() const;	//when the world added this actor, earlier actors come first in m_gameObjects
+	void setWorldOrder(unsigned long long order);
 
 		
 		
@@ -29,6 +41,8 @@ public:
 private:
 	bool m_alive;		//all objects need a world and start can be alive/dead
 	StudentWorld* m_world;
+	RandomStream m_random;
+	unsigned long long m_worldOrder;
 
 };
 
@@ -51,8 +65,9 @@ class Socrates : public movingActor
 {
 public:
 	Socrates(StudentWorld* sw);
+	virtual ActorType type() const;
 	virtual void doSomething();
-	void socratesMoveTo(double angle);	//socrates moves in a special circle around the edge
+	void socratesMoveTo(int angle);	//socrates moves in a special circle around the edge, angle in degrees
 	void addFlame();
 	virtual void playSoundHurt() const;
 	virtual void playSoundDie() const;
@@ -64,15 +79,18 @@ public:
 private:
 	int m_sprayCharges;
 	int m_flameCharges;
+	int m_positionAngle;	//degrees around the dish, kept exact instead of recovered from x and y
 };
 
 class DirtPile : public Actor
 {
 public:
 	DirtPile(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void doSomething();
 	virtual bool canOverLap() const;	//dirt piles can overlap with each other
 	virtual bool blocksMovement() const;	//movingactors cannot move over dirt
+	virtual bool actsEachTick() const;	//false, dirt only waits to be destroyed
 
 private:
 };
@@ -81,9 +99,11 @@ class Food : public Actor
 {
 public:
 	Food(StudentWorld* sw, double startX, double StartY);
+	virtual ActorType type() const;
 	virtual void doSomething();
 	virtual bool isDamageable() const;	//false
 	virtual bool isEdible() const;	//can be eaten by bacteria
+	virtual bool actsEachTick() const;	//false, food only waits to be eaten
 private:
 
 };
@@ -92,6 +112,7 @@ class Pit : public Actor
 {
 public:
 	Pit(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void doSomething();
 	virtual bool isDamageable() const;	//pits can't be damaged
 	virtual bool preventsLevelCompleting() const;
@@ -102,36 +123,6 @@ private:
 	int m_eColi;
 };
 
-class Projectile : public Actor
-{
-public:
-	Projectile(StudentWorld* sw, double startX, double StartY, double direction, double range, double damage, int type);
-	virtual void doSomething();
-	double giveDamage() const;
-	virtual bool isDamageable() const;	//projectiles cannot be damaged by themselves
-
-private:
-	double m_range;		//projectiles have a max range, a damage, and a distance of how far they have traveled
-	double m_damage;
-	double m_distance;
-};
-
-class Spray : public Projectile
-{
-public:
-	Spray(StudentWorld* sw, double startX, double startY, double direction);
-private:
-
-};
-
-class Flame : public Projectile
-{
-public:
-	Flame(StudentWorld* sw, double startX, double startY, double direction);
-private:
-
-};
-
 class Goodie : public Actor
 {
 public:
@@ -151,6 +142,7 @@ class HealthGoodie : public Goodie
 {
 public:
 	HealthGoodie(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void goodieAction(Socrates* s);
 private:
 
@@ -160,6 +152,7 @@ class FlameThrowerGoodie : public Goodie
 {
 public:
 	FlameThrowerGoodie(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void goodieAction(Socrates* s);
 private:
 };
@@ -168,6 +161,7 @@ class ExtraLifeGoodie : public Goodie
 {
 public: 
 	ExtraLifeGoodie(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void goodieAction(Socrates* s);
 private:
 };
@@ -176,14 +170,32 @@ class Fungus : public Goodie
 {
 public: 
 	Fungus(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void goodieAction(Socrates* s);
 };
 
+struct BacteriumPlan		//what a bacterium decided to do this tick, carried out by commitTick
+{
+	bool dies = false;
+	bool dropsFood = false;
+	bool moves = false;
+	double moveX = 0;
+	double moveY = 0;
+	int socratesDamage = 0;
+	Actor* food = nullptr;		//food to eat, if nothing else eats it first
+	bool multiplies = false;
+	double childX = 0;
+	double childY = 0;
+	RandomStream spawnParent;	//this bacterium's stream as it was when it decided to spawn
+};
+
 class Bacterium : public movingActor
 {
 public:
 	Bacterium(StudentWorld* sw, int image, double startX, double startY, int health, int damage);
-	virtual void doSomething();
+	virtual void doSomething();		//plan and commit at once
+	virtual void planTick();	//decide, reading the world but only changing this bacterium
+	virtual void commitTick();	//carry out the plan: move, eat, hurt socrates, multiply or die
 	virtual bool preventsLevelCompleting() const;
 	virtual void multiplyBacteria(double x, double y) = 0;	//multiplies each individual bacteria type
 	virtual bool aggressiveSalmonellaSpecific();	//specific function for aggressive Salmonella do something
@@ -191,12 +203,16 @@ public:
 	int movePlanDistance() const;	
 	void decrementMovePlan();
 	void resetMovePlan();	//change direction and reset move distance
+	void planMoveTo(double x, double y);	//move there in commitTick
 
 
 private:
 	int m_movePlanDistance;
 	int m_foodEaten;
 	int m_damage;
+	BacteriumPlan m_plan;
+
+	void reserveSpawn();	//remember this bacterium's stream so a child made in commitTick splits from it as if made now
 };
 
 class Salmonella : public Bacterium
@@ -215,6 +231,7 @@ class RegularSalmonella : public Salmonella
 {
 public:
 	RegularSalmonella(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void multiplyBacteria(double x, double y);
 
 private:
@@ -225,6 +242,7 @@ class AggressiveSalmonella : public Salmonella
 {
 public:
 	AggressiveSalmonella(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual bool aggressiveSalmonellaSpecific();
 	virtual void multiplyBacteria(double x, double y);
 
@@ -236,6 +254,7 @@ class Ecoli : public Bacterium
 {
 public:
 	Ecoli(StudentWorld* sw, double startX, double startY);
+	virtual ActorType type() const;
 	virtual void bacteriumSpecific();
 	virtual void playSoundHurt() const;
 	virtual void playSoundDie() const;
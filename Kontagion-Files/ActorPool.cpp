@@ -0,0 +1,94 @@
+#include "ActorPool.h"
+#include <new>
+#include <algorithm>
+
+ActorPool::~ActorPool()
+{
+	for (std::size_t i = 0; i < m_chunks.size(); i++)
+		::operator delete(m_chunks[i]);
+}
+
+ActorPool& ActorPool::local()
+{
+	static thread_local ActorPool pool;
+	return pool;
+}
+
+int ActorPool::sizeClass(std::size_t size)
+{
+	int c = static_cast<int>((size + GRANULE - 1) / GRANULE) - 1;
+	if (c >= NUM_SIZE_CLASSES)
+		return -1;
+	return std::max(c, 0);
+}
+
+void ActorPool::refill(int c)	//carve a new chunk into free slots of one size class
+{
+	std::size_t slotSize = (c + 1) * GRANULE;
+	char* chunk = static_cast<char*>(::operator new(slotSize * SLOTS_PER_CHUNK));
+	m_chunks.push_back(chunk);
+	for (int i = SLOTS_PER_CHUNK - 1; i >= 0; i--)		//push in reverse so slots are handed out in address order
+	{
+		FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + i * slotSize);
+		slot->next = m_classes[c].freeList;
+		m_classes[c].freeList = slot;
+	}
+	m_classes[c].stats.reserved += SLOTS_PER_CHUNK;
+	m_classes[c].stats.chunks++;
+}
+
+void* ActorPool::allocate(std::size_t size)
+{
+	int c = sizeClass(size);
+	if (c < 0)
+		return ::operator new(size);
+	SizeClass& sc = m_classes[c];
+	if (sc.freeList == nullptr)
+		refill(c);
+	FreeSlot* slot = sc.freeList;
+	sc.freeList = slot->next;
+	sc.stats.inUse++;
+	sc.stats.highWater = std::max(sc.stats.highWater, sc.stats.inUse);
+	m_inUse++;
+	m_highWater = std::max(m_highWater, m_inUse);
+	return slot;
+}
+
+void ActorPool::deallocate(void* p, std::size_t size)
+{
+	if (p == nullptr)
+		return;
+	int c = sizeClass(size);
+	if (c < 0)
+	{
+		::operator delete(p);
+		return;
+	}
+	SizeClass& sc = m_classes[c];
+	FreeSlot* slot = static_cast<FreeSlot*>(p);
+	slot->next = sc.freeList;
+	sc.freeList = slot;
+	sc.stats.inUse--;
+	m_inUse--;
+}
+
+ActorPool::Stats ActorPool::stats() const
+{
+	Stats total;
+	total.inUse = m_inUse;
+	total.highWater = m_highWater;		//the classes peak at different times, so their peaks don't add up to this
+	for (int c = 0; c < NUM_SIZE_CLASSES; c++)
+	{
+		total.reserved += m_classes[c].stats.reserved;
+		total.chunks += m_classes[c].stats.chunks;
+	}
+	return total;
+}
+
+ActorPool::Stats ActorPool::stats(std::size_t size) const
+{
+	int c = sizeClass(size);
+	if (c < 0)
+		return Stats();
+	return m_classes[c].stats;
+}
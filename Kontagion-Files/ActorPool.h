@@ -0,0 +1,63 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include <cstddef>
+#include <vector>
+
+// Free-list pools for the Actor hierarchy. Every Actor subclass is allocated
+// through Actor::operator new, which lands here; each object size gets its own
+// free list carved out of large chunks, so once a level has warmed up spawning
+// and destroying sprays, flames, food and bacteria never calls the system
+// allocator. Pools are per thread (each world runs on one thread), and an actor
+// must be deleted on the thread that created it.
+class ActorPool
+{
+public:
+	struct Stats
+	{
+		std::size_t inUse = 0;		//slots currently holding an actor
+		std::size_t highWater = 0;	//most slots ever in use at once
+		std::size_t reserved = 0;	//slots carved out of chunks so far
+		std::size_t chunks = 0;		//chunks requested from the system allocator
+	};
+
+	static const std::size_t GRANULE = 16;		//slot sizes are rounded up to this
+	static const int NUM_SIZE_CLASSES = 24;		//objects bigger than GRANULE * NUM_SIZE_CLASSES bypass the pool
+
+	~ActorPool();
+	static ActorPool& local();		//the calling thread's pool
+
+	void* allocate(std::size_t size);
+	void deallocate(void* p, std::size_t size);
+
+	Stats stats() const;		//totals over every size class
+	Stats stats(std::size_t size) const;	//the size class objects of this size come from
+
+private:
+	static const int SLOTS_PER_CHUNK = 128;
+
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	struct SizeClass
+	{
+		FreeSlot* freeList = nullptr;
+		Stats stats;
+	};
+
+	SizeClass m_classes[NUM_SIZE_CLASSES];
+	std::size_t m_inUse = 0;		//over every size class, so the overall peak can be tracked
+	std::size_t m_highWater = 0;
+	std::vector<void*> m_chunks;
+
+	ActorPool() {}
+	ActorPool(const ActorPool&) = delete;
+	ActorPool& operator=(const ActorPool&) = delete;
+
+	static int sizeClass(std::size_t size);		//-1 if too big to pool
+	void refill(int sizeClass);
+};
+
+#endif // ACTORPOOL_H_
@@ -0,0 +1,119 @@
+#include "AssetPack.h"
+#include <fstream>
+#include <cstring>
+using namespace std;
+
+AssetPack::AssetPack()
+ : m_entries(nullptr), m_count(0)
+{
+}
+
+bool AssetPack::open(const string& fileName)
+{
+    m_entries = nullptr;
+    m_count = 0;
+    if (!m_file.open(fileName))
+        return false;
+    if (!validate())
+    {
+        m_file.close();
+        return false;
+    }
+    Header header;
+    memcpy(&header, m_file.data(), sizeof(header));
+    m_entries = reinterpret_cast<const Entry*>(m_file.data() + sizeof(header));
+    m_count = header.count;
+    return true;
+}
+
+  // Checks everything up front, so find can trust the index
+bool AssetPack::validate() const
+{
+    const unsigned char* data = m_file.data();
+    size_t size = m_file.size();
+    Header header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != MAGIC  ||  header.version != VERSION  ||
+        header.count > (size - sizeof(header)) / sizeof(Entry))
+        return false;
+    const Entry* entries = reinterpret_cast<const Entry*>(data + sizeof(header));
+    for (uint32_t i = 0; i < header.count; i++)
+    {
+        const Entry& e = entries[i];
+        if (memchr(e.name, '\0', MAX_NAME) == nullptr  ||  e.offset > size  ||  e.size > size - e.offset)
+            return false;
+        if (i > 0  &&  strcmp(entries[i-1].name, e.name) >= 0)
+            return false;
+    }
+    return true;
+}
+
+bool AssetPack::find(const string& name, const unsigned char*& data, size_t& size) const
+{
+    uint32_t low = 0;
+    uint32_t high = m_count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        int cmp = strcmp(m_entries[mid].name, name.c_str());
+        if (cmp == 0)
+        {
+            data = m_file.data() + m_entries[mid].offset;
+            size = static_cast<size_t>(m_entries[mid].size);
+            return true;
+        }
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return false;
+}
+
+bool AssetPackWriter::add(const string& name, const void* data, size_t size)
+{
+    if (name.size() >= AssetPack::MAX_NAME  ||  m_blobs.count(name) > 0)
+        return false;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    m_blobs[name].assign(bytes, bytes + size);
+    return true;
+}
+
+bool AssetPackWriter::write(const string& fileName) const
+{
+    auto align = [](uint64_t offset) {
+        return (offset + AssetPack::ALIGNMENT - 1) / AssetPack::ALIGNMENT * AssetPack::ALIGNMENT;
+    };
+
+    AssetPack::Header header = { AssetPack::MAGIC, AssetPack::VERSION, static_cast<uint32_t>(m_blobs.size()), 0 };
+    vector<AssetPack::Entry> entries;
+    uint64_t offset = align(sizeof(header) + m_blobs.size() * sizeof(AssetPack::Entry));
+    for (const auto& blob : m_blobs)
+    {
+        AssetPack::Entry e;
+        memset(&e, 0, sizeof(e));
+        strcpy(e.name, blob.first.c_str());
+        e.offset = offset;
+        e.size = blob.second.size();
+        entries.push_back(e);
+        offset = align(offset + e.size);
+    }
+
+    ofstream out(fileName, ios::binary);
+    if (!out)
+        return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetPack::Entry));
+    int i = 0;
+    for (const auto& blob : m_blobs)
+    {
+        uint64_t at = static_cast<uint64_t>(out.tellp());
+        for ( ; at < entries[i].offset; at++)
+            out.put('\0');
+        out.write(reinterpret_cast<const char*>(blob.second.data()), blob.second.size());
+        i++;
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,84 @@
+#ifndef ASSETPACK_H_
+#define ASSETPACK_H_
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+
+  // The pack tools/assetpack builds from the Assets directory; when it is
+  // there the game opens it instead of the loose files.
+const char* const ASSET_PACK_FILE = "kontagion.pak";
+
+  // A single file holding named blobs.  It starts with a header and an index
+  // of entries sorted by name, followed by the blobs, each starting on an
+  // ALIGNMENT boundary.  The pack is memory-mapped, so find returns a pointer
+  // straight into the file, good until the pack is closed.  Numbers are
+  // stored little-endian, as every platform the game builds for is.
+  //
+  //     Header  { magic "KPAK", version, entry count, 0 }
+  //     Entry[] { name (null-terminated), offset, size }
+  //     blobs
+
+class AssetPack
+{
+  public:
+    static constexpr std::uint32_t MAGIC = 0x4B41504B;  // "KPAK"
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr int ALIGNMENT = 64;
+    static constexpr int MAX_NAME = 48;                 // including the null
+
+    AssetPack();
+
+      // False if the file is missing or is not a pack of this version
+    bool open(const std::string& fileName);
+
+    bool isOpen() const
+    {
+        return m_entries != nullptr;
+    }
+
+    bool find(const std::string& name, const unsigned char*& data, std::size_t& size) const;
+
+  private:
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint32_t reserved;
+    };
+
+    struct Entry
+    {
+        char          name[MAX_NAME];
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    friend class AssetPackWriter;
+
+    MappedFile    m_file;
+    const Entry*  m_entries;
+    std::uint32_t m_count;
+
+    bool validate() const;
+};
+
+  // Collects blobs and writes them out as an AssetPack.
+
+class AssetPackWriter
+{
+  public:
+      // False if the name is too long or already added
+    bool add(const std::string& name, const void* data, std::size_t size);
+
+    bool write(const std::string& fileName) const;
+
+  private:
+    std::map<std::string, std::vector<unsigned char>> m_blobs;  // in index order
+};
+
+#endif // ASSETPACK_H_
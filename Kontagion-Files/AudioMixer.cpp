@@ -0,0 +1,301 @@
+#include "AudioMixer.h"
+#include "GameConstants.h"
+#include "MappedFile.h"
+#include "AssetPack.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+  // Reads a little-endian unsigned value of the given size
+static uint32_t readLittleEndian(const uint8_t* p, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++)
+        value |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return value;
+}
+
+  // One sample of an integer PCM stream scaled to 16 bits
+static int readSample(const uint8_t* p, int bytes)
+{
+    switch (bytes)
+    {
+        case 1:  return (static_cast<int>(p[0]) - 128) * 256;  // 8-bit is unsigned
+        case 2:  return static_cast<int16_t>(readLittleEndian(p, 2));
+        case 3:  return static_cast<int32_t>(readLittleEndian(p, 3) << 8) >> 16;
+        default: return static_cast<int32_t>(readLittleEndian(p, 4)) >> 16;
+    }
+}
+
+  // Decodes the bytes of a PCM .wav file into interleaved 16-bit stereo at
+  // rate frames per second, linearly resampling if the file was recorded at
+  // another rate.
+static bool decodeWav(const uint8_t* wav, size_t wavSize, int rate, vector<int16_t>& out, int& frames)
+{
+    if (wavSize < 12  ||  memcmp(wav, "RIFF", 4) != 0  ||  memcmp(wav + 8, "WAVE", 4) != 0)
+        return false;
+
+    int format = 0;
+    int channels = 0;
+    int fileRate = 0;
+    int bits = 0;
+    const uint8_t* data = nullptr;
+    size_t dataBytes = 0;
+    for (size_t pos = 12; pos + 8 <= wavSize; )
+    {
+        const uint8_t* chunk = wav + pos;
+        size_t size = min<size_t>(readLittleEndian(chunk + 4, 4), wavSize - pos - 8);
+        if (memcmp(chunk, "fmt ", 4) == 0  &&  size >= 16)
+        {
+            format = readLittleEndian(chunk + 8, 2);
+            channels = readLittleEndian(chunk + 10, 2);
+            fileRate = readLittleEndian(chunk + 12, 4);
+            bits = readLittleEndian(chunk + 22, 2);
+            if (format == 0xFFFE  &&  size >= 26)   // WAVE_FORMAT_EXTENSIBLE names its real format here
+                format = readLittleEndian(chunk + 32, 2);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            data = chunk + 8;
+            dataBytes = size;
+        }
+        pos += 8 + size + (size & 1);  // chunks are padded to an even size
+    }
+    if (format != 1  ||  channels <= 0  ||  fileRate <= 0  ||  data == nullptr)
+        return false;
+    if (bits != 8  &&  bits != 16  &&  bits != 24  &&  bits != 32)
+        return false;
+
+    int bytes = bits / 8;
+    int fileFrames = static_cast<int>(dataBytes / (bytes * channels));
+    auto sampleAt = [&](int frame, int channel) {
+        channel = min(channel, channels - 1);  // mono plays on both sides
+        return readSample(data + (static_cast<size_t>(frame) * channels + channel) * bytes, bytes);
+    };
+
+    frames = static_cast<int>(static_cast<int64_t>(fileFrames) * rate / fileRate);
+    if (frames <= 0)  // nothing to play, and a voice must have a sample to point at
+        return false;
+    out.resize(static_cast<size_t>(frames) * 2);
+    for (int i = 0; i < frames; i++)
+    {
+        double source = static_cast<double>(i) * fileRate / rate;
+        int first = static_cast<int>(source);
+        int second = min(first + 1, fileFrames - 1);
+        double t = source - first;
+        for (int c = 0; c < 2; c++)
+            out[2*i + c] = static_cast<int16_t>(sampleAt(first, c) * (1 - t) + sampleAt(second, c) * t);
+    }
+    return true;
+}
+
+AudioMixer::AudioMixer(unique_ptr<AudioSink> sink)
+ : m_sink(move(sink)), m_writePos(0), m_readPos(0), m_running(false),
+   m_played(0), m_dropped(0), m_stolen(0), m_skipped(0), m_blocksMixed(0)
+{
+    m_voices.reserve(MAX_VOICES);
+}
+
+AudioMixer::~AudioMixer()
+{
+    m_running = false;
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool AudioMixer::loadClip(int soundID, const string& wavFile, int priority, int maxVoices)
+{
+    MappedFile file;
+    if (m_clipFiles.count(wavFile) == 0  &&  !file.open(wavFile))
+        return false;
+    return loadClip(soundID, wavFile, file.data(), file.size(), priority, maxVoices);
+}
+
+bool AudioMixer::loadClip(int soundID, const string& name, const unsigned char* wav, size_t size,
+                          int priority, int maxVoices)
+{
+    if (soundID < 0  ||  m_thread.joinable())  // the mixer thread reads m_sounds unlocked
+        return false;
+
+    shared_ptr<const Clip>& clip = m_clipFiles[name];
+    if (clip == nullptr)
+    {
+        shared_ptr<Clip> decoded = make_shared<Clip>();
+        if (!decodeWav(wav, size, SAMPLE_RATE, decoded->samples, decoded->frames))
+        {
+            m_clipFiles.erase(name);
+            return false;
+        }
+        clip = decoded;
+    }
+    if (static_cast<size_t>(soundID) >= m_sounds.size())
+        m_sounds.resize(soundID + 1);
+    m_sounds[soundID] = Sound{ clip, priority, max(maxVoices, 1) };
+    return true;
+}
+
+int AudioMixer::loadGameSounds(const string& assetPath, const AssetPack* pack)
+{
+    int failed = 0;
+    for (const SoundInfo& s : SOUND_INFO)
+    {
+        const unsigned char* wav;
+        size_t size;
+        bool loaded;
+        if (pack != nullptr  &&  pack->find(s.fileName, wav, size))
+            loaded = loadClip(s.soundID, s.fileName, wav, size, s.priority, s.maxVoices);
+        else
+            loaded = loadClip(s.soundID, assetPath + s.fileName, s.priority, s.maxVoices);
+        if (!loaded)
+            failed++;
+    }
+    return failed;
+}
+
+void AudioMixer::start()
+{
+    if (m_thread.joinable())
+        return;
+    m_running = true;
+    m_thread = thread(&AudioMixer::mixerMain, this);
+}
+
+void AudioMixer::play(int soundID)
+{
+    if (soundID >= 0)
+        push(soundID);
+}
+
+void AudioMixer::stopAll()
+{
+    push(STOP_ALL);
+}
+
+AudioMixer::Stats AudioMixer::stats() const
+{
+    Stats s;
+    s.played = m_played;
+    s.dropped = m_dropped;
+    s.stolen = m_stolen;
+    s.skipped = m_skipped;
+    s.blocksMixed = m_blocksMixed;
+    return s;
+}
+
+void AudioMixer::push(int command)
+{
+    unsigned write = m_writePos.load(memory_order_relaxed);
+    if (write - m_readPos.load(memory_order_acquire) == QUEUE_SIZE)
+    {
+        m_dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    m_commands[write % QUEUE_SIZE] = command;
+    m_writePos.store(write + 1, memory_order_release);  // publishes the command
+}
+
+void AudioMixer::drainCommands()
+{
+    unsigned read = m_readPos.load(memory_order_relaxed);
+    unsigned write = m_writePos.load(memory_order_acquire);
+    for ( ; read != write; read++)
+    {
+        int command = m_commands[read % QUEUE_SIZE];
+        if (command == STOP_ALL)
+            m_voices.clear();
+        else
+            startVoice(command);
+    }
+    m_readPos.store(read, memory_order_release);  // hands the slots back
+}
+
+void AudioMixer::startVoice(int soundID)
+{
+    if (static_cast<size_t>(soundID) >= m_sounds.size()  ||  m_sounds[soundID].clip == nullptr)
+        return;
+    const Sound& sound = m_sounds[soundID];
+    Voice voice = { sound.clip.get(), soundID, sound.priority, 0 };
+
+    Voice* victim = nullptr;
+    int copies = 0;
+    for (Voice& v : m_voices)
+    {
+        if (v.soundID == soundID)
+        {
+            copies++;
+            if (victim == nullptr  ||  v.position > victim->position)
+                victim = &v;
+        }
+    }
+    if (copies < sound.maxVoices)
+    {
+        if (m_voices.size() < MAX_VOICES)
+        {
+            m_voices.push_back(voice);
+            m_played.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        victim = &m_voices[0];
+        for (Voice& v : m_voices)
+        {
+            if (v.priority < victim->priority  ||
+                (v.priority == victim->priority  &&  v.position > victim->position))
+                victim = &v;
+        }
+        if (victim->priority > voice.priority)
+        {
+            m_skipped.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+    }
+    *victim = voice;
+    m_stolen.fetch_add(1, memory_order_relaxed);
+    m_played.fetch_add(1, memory_order_relaxed);
+}
+
+void AudioMixer::mixBlock(int16_t* out)
+{
+    int32_t sum[BLOCK_FRAMES * 2] = {};
+    for (Voice& v : m_voices)
+    {
+        int frames = min(BLOCK_FRAMES, v.clip->frames - v.position);
+        const int16_t* in = &v.clip->samples[static_cast<size_t>(v.position) * 2];
+        for (int i = 0; i < frames * 2; i++)
+            sum[i] += in[i];
+        v.position += frames;
+    }
+    m_voices.erase(remove_if(m_voices.begin(), m_voices.end(),
+                    [](const Voice& v) { return v.position >= v.clip->frames; }),
+                   m_voices.end());
+
+    for (int i = 0; i < BLOCK_FRAMES * 2; i++)  // clip rather than wrap when voices pile up
+        out[i] = static_cast<int16_t>(max(-32768, min(32767, sum[i])));
+}
+
+void AudioMixer::mixerMain()
+{
+    int16_t block[BLOCK_FRAMES * 2];
+    auto begin = chrono::steady_clock::now();
+    long long framesMixed = 0;
+    while (m_running)
+    {
+        drainCommands();
+        mixBlock(block);
+        m_sink->write(block, BLOCK_FRAMES);
+        m_blocksMixed.fetch_add(1, memory_order_relaxed);
+
+        if (m_sink->pacesWrites())
+        {
+              // the device kept time; if it stops, keep it from here on
+            begin = chrono::steady_clock::now();
+            framesMixed = 0;
+            continue;
+        }
+
+          // Sleep until the sample clock catches up, measured from the start
+          // so rounding in one block's length never accumulates into drift.
+        framesMixed += BLOCK_FRAMES;
+        this_thread::sleep_until(begin + chrono::nanoseconds(framesMixed * 1000000000LL / SAMPLE_RATE));
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef AUDIOMIXER_H_
+#define AUDIOMIXER_H_
+
+#include "AudioSink.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+class AssetPack;
+
+  // Mixes the game's sounds on a thread of its own.  Every clip is decoded
+  // from its .wav file into 16-bit stereo at SAMPLE_RATE once, before start;
+  // after that, play and stopAll only drop a command into a fixed-size
+  // lock-free queue, so the game thread never touches a file, allocates or
+  // waits on the mixer.  The mixer thread drains the queue, adds up to
+  // MAX_VOICES playing clips into blocks of BLOCK_FRAMES frames and hands
+  // each block to its AudioSink, which a sound device paces; for other sinks
+  // the mixer paces itself to the sample rate.  A sound already playing as
+  // many times as it may takes over its own oldest voice; otherwise, with
+  // every voice busy, the lowest priority one gives way, or the new sound is
+  // skipped if nothing playing ranks below it.
+  //
+  // play and stopAll must all be called from one thread (the queue has a
+  // single producer).  A command that finds the queue full is dropped and
+  // counted rather than waited on.
+
+class AudioMixer
+{
+  public:
+    static constexpr int SAMPLE_RATE  = 44100;
+    static constexpr int BLOCK_FRAMES = 512;
+    static constexpr int MAX_VOICES   = 32;
+    static constexpr int QUEUE_SIZE   = 256;
+
+    struct Stats
+    {
+        long played = 0;        // voices started
+        long dropped = 0;       // commands lost to a full queue
+        long stolen = 0;        // voices cut short to make room for new ones
+        long skipped = 0;       // sounds outranked by everything playing
+        long blocksMixed = 0;
+    };
+
+    explicit AudioMixer(std::unique_ptr<AudioSink> sink);
+    ~AudioMixer();              // stops and joins the mixer thread
+
+      // Decodes a PCM .wav file (8, 16, 24 or 32 bits, any channel count and
+      // rate) for soundID.  Only before start; a file loaded for an earlier
+      // ID is shared rather than decoded again.
+    bool loadClip(int soundID, const std::string& wavFile,
+                  int priority = 0, int maxVoices = MAX_VOICES);
+
+      // The same for a .wav file already in memory; name identifies it for
+      // sharing and the bytes are only read during the call.
+    bool loadClip(int soundID, const std::string& name, const unsigned char* wav, std::size_t size,
+                  int priority = 0, int maxVoices = MAX_VOICES);
+
+      // Loads every clip in SOUND_INFO, from pack if it is given and holds
+      // the file, otherwise from assetPath, and returns how many could not be
+      // loaded.
+    int loadGameSounds(const std::string& assetPath, const AssetPack* pack = nullptr);
+
+    void start();
+
+    void play(int soundID);
+    void stopAll();
+
+    Stats stats() const;
+
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+  private:
+    struct Clip
+    {
+        std::vector<std::int16_t> samples;  // interleaved left/right
+        int frames;
+    };
+
+    struct Sound
+    {
+        std::shared_ptr<const Clip> clip;
+        int priority;
+        int maxVoices;
+    };
+
+    struct Voice
+    {
+        const Clip* clip;
+        int         soundID;
+        int         priority;
+        int         position;   // next frame to mix
+    };
+
+    static constexpr int STOP_ALL = -1;
+
+    std::unique_ptr<AudioSink>                m_sink;
+    std::vector<Sound>                        m_sounds;     // by sound ID
+    std::map<std::string, std::shared_ptr<const Clip>> m_clipFiles;
+
+      // single producer, single consumer ring of commands
+    int                    m_commands[QUEUE_SIZE];
+    std::atomic<unsigned>  m_writePos;
+    std::atomic<unsigned>  m_readPos;
+
+    std::vector<Voice>     m_voices;    // mixer thread only
+    std::atomic<bool>      m_running;
+    std::thread            m_thread;
+
+    std::atomic<long>      m_played;
+    std::atomic<long>      m_dropped;
+    std::atomic<long>      m_stolen;
+    std::atomic<long>      m_skipped;
+    std::atomic<long>      m_blocksMixed;
+
+    void push(int command);
+    void drainCommands();
+    void startVoice(int soundID);
+    void mixBlock(std::int16_t* out);
+    void mixerMain();
+};
+
+#endif // AUDIOMIXER_H_
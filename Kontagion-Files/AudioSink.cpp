@@ -0,0 +1,50 @@
+#include "AudioSink.h"
+using namespace std;
+
+static void putLittleEndian(ofstream& out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+WavFileAudioSink::WavFileAudioSink(string fileName, int sampleRate)
+ : m_file(fileName, ios::binary), m_sampleRate(sampleRate), m_dataBytes(0)
+{
+    if (m_file)
+        writeHeader();  // placeholder sizes until the destructor knows them
+}
+
+WavFileAudioSink::~WavFileAudioSink()
+{
+    if (!m_file)
+        return;
+    m_file.seekp(0);
+    writeHeader();
+}
+
+void WavFileAudioSink::write(const int16_t* samples, int frames)
+{
+    if (!m_file)
+        return;
+    for (int i = 0; i < frames * 2; i++)
+        putLittleEndian(m_file, static_cast<uint16_t>(samples[i]), 2);
+    m_dataBytes += frames * 4;
+}
+
+void WavFileAudioSink::writeHeader()
+{
+    const int CHANNELS = 2;
+    const int BYTES_PER_SAMPLE = 2;
+    m_file.write("RIFF", 4);
+    putLittleEndian(m_file, 36 + m_dataBytes, 4);
+    m_file.write("WAVEfmt ", 8);
+    putLittleEndian(m_file, 16, 4);
+    putLittleEndian(m_file, 1, 2);  // PCM
+    putLittleEndian(m_file, CHANNELS, 2);
+    putLittleEndian(m_file, m_sampleRate, 4);
+    putLittleEndian(m_file, m_sampleRate * CHANNELS * BYTES_PER_SAMPLE, 4);
+    putLittleEndian(m_file, CHANNELS * BYTES_PER_SAMPLE, 2);
+    putLittleEndian(m_file, 8 * BYTES_PER_SAMPLE, 2);
+    m_file.write("data", 4);
+    putLittleEndian(m_file, m_dataBytes, 4);
+}
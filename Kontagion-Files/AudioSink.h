@@ -0,0 +1,77 @@
+#ifndef AUDIOSINK_H_
+#define AUDIOSINK_H_
+
+#include <cstdint>
+#include <string>
+#include <fstream>
+
+  // Where the AudioMixer sends what it has mixed: blocks of interleaved
+  // 16-bit stereo frames at the mixer's sample rate.  write is called only
+  // from the mixer thread.
+
+class AudioSink
+{
+  public:
+    virtual ~AudioSink()
+    {
+    }
+
+    virtual void write(const std::int16_t* samples, int frames) = 0;
+
+      // True if write waits until the samples are due, as a sound device's
+      // does; otherwise the mixer sleeps between blocks to keep real time.
+    virtual bool pacesWrites() const
+    {
+        return false;
+    }
+};
+
+  // Discards everything, for machines with nowhere to play sound.
+
+class NullAudioSink : public AudioSink
+{
+  public:
+    NullAudioSink()
+     : m_framesWritten(0)
+    {
+    }
+
+    virtual void write(const std::int16_t*, int frames)
+    {
+        m_framesWritten += frames;
+    }
+
+    long framesWritten() const
+    {
+        return m_framesWritten;
+    }
+
+  private:
+    long m_framesWritten;
+};
+
+  // Records the mix to a 16-bit stereo .wav file.  The header's sizes are
+  // filled in when the sink is destroyed.
+
+class WavFileAudioSink : public AudioSink
+{
+  public:
+    WavFileAudioSink(std::string fileName, int sampleRate);
+    virtual ~WavFileAudioSink();
+
+    bool isOpen() const
+    {
+        return m_file.is_open();
+    }
+
+    virtual void write(const std::int16_t* samples, int frames);
+
+  private:
+    std::ofstream m_file;
+    int           m_sampleRate;
+    std::uint32_t m_dataBytes;
+
+    void writeHeader();
+};
+
+#endif // AUDIOSINK_H_
@@ -0,0 +1,127 @@
+#ifndef DEVICEAUDIOSINK_H_
+#define DEVICEAUDIOSINK_H_
+
+#include "AudioSink.h"
+#include <memory>
+
+  // Plays the mix on the machine's sound device.  On Linux that is ALSA's
+  // default device, which PulseAudio and PipeWire also serve.  libasound is
+  // loaded when the sink opens rather than linked, so the game builds without
+  // its headers and runs silent without it.  write blocks until the device has
+  // room, which paces the mixer.  Elsewhere no device sink exists yet and
+  // SoundFX.h plays the sounds.
+
+#if defined(__linux__)
+
+#include <dlfcn.h>
+
+class DeviceAudioSink : public AudioSink
+{
+  public:
+      // Null if there is no device to play on
+    static std::unique_ptr<AudioSink> open(int sampleRate)
+    {
+        std::unique_ptr<DeviceAudioSink> sink(new DeviceAudioSink);
+        if (!sink->openDevice(sampleRate))
+            return nullptr;
+        return sink;
+    }
+
+    virtual ~DeviceAudioSink()
+    {
+        if (m_pcm != nullptr)
+            m_close(m_pcm);
+        if (m_library != nullptr)
+            dlclose(m_library);
+    }
+
+    virtual void write(const std::int16_t* samples, int frames)
+    {
+        while (frames > 0  &&  m_pcm != nullptr)
+        {
+            long written = m_writei(m_pcm, samples, frames);
+            if (written < 0)
+            {
+                  // an underrun or a suspend; if the device can't be brought
+                  // back, stop using it and let the mixer pace itself
+                if (m_recover(m_pcm, static_cast<int>(written), 1) < 0)
+                {
+                    m_close(m_pcm);
+                    m_pcm = nullptr;
+                }
+                continue;
+            }
+            samples += written * 2;
+            frames -= static_cast<int>(written);
+        }
+    }
+
+    virtual bool pacesWrites() const
+    {
+        return m_pcm != nullptr;
+    }
+
+  private:
+    struct Pcm;
+
+      // The few libasound entry points used, with the values of the enums
+      // they take, since its headers may not be installed
+    static const int STREAM_PLAYBACK = 0;
+    static const int FORMAT_S16_LE = 2;
+    static const int ACCESS_RW_INTERLEAVED = 3;
+    static const unsigned LATENCY_US = 50000;   // the device's buffer, enough to ride out a busy frame
+
+    using OpenFunc = int (*)(Pcm** pcm, const char* name, int stream, int mode);
+    using SetParamsFunc = int (*)(Pcm* pcm, int format, int access, unsigned channels, unsigned rate,
+                                  int softResample, unsigned latencyUs);
+    using WriteiFunc = long (*)(Pcm* pcm, const void* buffer, unsigned long frames);
+    using RecoverFunc = int (*)(Pcm* pcm, int err, int silent);
+    using CloseFunc = int (*)(Pcm* pcm);
+
+    void*       m_library;
+    Pcm*        m_pcm;
+    WriteiFunc  m_writei;
+    RecoverFunc m_recover;
+    CloseFunc   m_close;
+
+    DeviceAudioSink()
+     : m_library(nullptr), m_pcm(nullptr), m_writei(nullptr), m_recover(nullptr), m_close(nullptr)
+    {
+    }
+
+    bool openDevice(int sampleRate)
+    {
+        m_library = dlopen("libasound.so.2", RTLD_NOW | RTLD_LOCAL);
+        if (m_library == nullptr)
+            return false;
+        OpenFunc open = reinterpret_cast<OpenFunc>(dlsym(m_library, "snd_pcm_open"));
+        SetParamsFunc setParams = reinterpret_cast<SetParamsFunc>(dlsym(m_library, "snd_pcm_set_params"));
+        m_writei = reinterpret_cast<WriteiFunc>(dlsym(m_library, "snd_pcm_writei"));
+        m_recover = reinterpret_cast<RecoverFunc>(dlsym(m_library, "snd_pcm_recover"));
+        m_close = reinterpret_cast<CloseFunc>(dlsym(m_library, "snd_pcm_close"));
+        if (open == nullptr  ||  setParams == nullptr  ||  m_writei == nullptr  ||  m_recover == nullptr  ||  m_close == nullptr)
+            return false;
+
+        if (open(&m_pcm, "default", STREAM_PLAYBACK, 0) < 0)
+        {
+            m_pcm = nullptr;
+            return false;
+        }
+        return setParams(m_pcm, FORMAT_S16_LE, ACCESS_RW_INTERLEAVED, 2, sampleRate, 1, LATENCY_US) >= 0;
+    }
+};
+
+#else
+
+class DeviceAudioSink
+{
+  public:
+    static std::unique_ptr<AudioSink> open(int /* sampleRate */)
+    {
+        return nullptr;
+    }
+};
+
+#endif
+
+#endif // DEVICEAUDIOSINK_H_
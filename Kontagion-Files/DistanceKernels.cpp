@@ -0,0 +1,141 @@
+#include "DistanceKernels.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define DISTANCE_KERNEL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DISTANCE_KERNEL_SSE2
+#endif
+
+namespace
+{
+	inline double distance2(const double* xs, const double* ys, int i, double x, double y)
+	{
+		double dx = xs[i] - x;
+		double dy = ys[i] - y;
+		return dx * dx + dy * dy;
+	}
+
+#if defined(DISTANCE_KERNEL_AVX)
+	const int LANES = 4;
+
+	inline int withinMask(const double* xs, const double* ys, int i, __m256d qx, __m256d qy, __m256d r2)
+	{
+		__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), qx);
+		__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), qy);
+		__m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		return _mm256_movemask_pd(_mm256_cmp_pd(d2, r2, _CMP_LE_OQ));
+	}
+
+	#define KERNEL_SETUP(x, y, r2) __m256d qx = _mm256_set1_pd(x), qy = _mm256_set1_pd(y), vr2 = _mm256_set1_pd(r2)
+	#define KERNEL_MASK(xs, ys, i) withinMask(xs, ys, i, qx, qy, vr2)
+#elif defined(DISTANCE_KERNEL_SSE2)
+	const int LANES = 2;
+
+	inline int withinMask(const double* xs, const double* ys, int i, __m128d qx, __m128d qy, __m128d r2)
+	{
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), qx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), qy);
+		__m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+		return _mm_movemask_pd(_mm_cmple_pd(d2, r2));
+	}
+
+	#define KERNEL_SETUP(x, y, r2) __m128d qx = _mm_set1_pd(x), qy = _mm_set1_pd(y), vr2 = _mm_set1_pd(r2)
+	#define KERNEL_MASK(xs, ys, i) withinMask(xs, ys, i, qx, qy, vr2)
+#endif
+}
+
+int firstWithinRadius(const double* xs, const double* ys, int n, double x, double y, double radius2)
+{
+	int i = 0;
+#ifdef KERNEL_SETUP
+	KERNEL_SETUP(x, y, radius2);
+	for ( ; i + LANES <= n; i += LANES)
+	{
+		int mask = KERNEL_MASK(xs, ys, i);
+		if (mask != 0)
+		{
+			for (int lane = 0; ; lane++)
+			{
+				if (mask & (1 << lane))
+					return i + lane;
+			}
+		}
+	}
+#endif
+	for ( ; i < n; i++)
+	{
+		if (distance2(xs, ys, i, x, y) <= radius2)
+			return i;
+	}
+	return -1;
+}
+
+int filterWithinRadius(const double* xs, const double* ys, int n, double x, double y, double radius2, int* out)
+{
+	int found = 0;
+	int i = 0;
+#ifdef KERNEL_SETUP
+	KERNEL_SETUP(x, y, radius2);
+	for ( ; i + LANES <= n; i += LANES)
+	{
+		int mask = KERNEL_MASK(xs, ys, i);
+		for (int lane = 0; mask != 0; lane++, mask >>= 1)
+		{
+			if (mask & 1)
+				out[found++] = i + lane;
+		}
+	}
+#endif
+	for ( ; i < n; i++)
+	{
+		if (distance2(xs, ys, i, x, y) <= radius2)
+			out[found++] = i;
+	}
+	return found;
+}
+
+int nearestWithinRadius(const double* xs, const double* ys, int n, double x, double y, double& bestDistance2)
+{
+	int best = -1;
+	int i = 0;
+#ifdef KERNEL_SETUP
+	for ( ; i + LANES <= n; i += LANES)
+	{
+		KERNEL_SETUP(x, y, bestDistance2);		//the bound shrinks as closer candidates turn up
+		if (KERNEL_MASK(xs, ys, i) == 0)	//whole group too far, the common case
+			continue;
+		for (int lane = 0; lane < LANES; lane++)
+		{
+			double d2 = distance2(xs, ys, i + lane, x, y);
+			if (d2 <= bestDistance2)
+			{
+				bestDistance2 = d2;
+				best = i + lane;
+			}
+		}
+	}
+#endif
+	for ( ; i < n; i++)
+	{
+		double d2 = distance2(xs, ys, i, x, y);
+		if (d2 <= bestDistance2)
+		{
+			bestDistance2 = d2;
+			best = i;
+		}
+	}
+	return best;
+}
+
+const char* distanceKernelName()
+{
+#if defined(DISTANCE_KERNEL_AVX)
+	return "avx";
+#elif defined(DISTANCE_KERNEL_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,22 @@
+#ifndef DISTANCEKERNELS_H_
+#define DISTANCEKERNELS_H_
+
+// Squared-distance tests over contiguous x/y arrays, comparing a query point
+// against several candidates per instruction. Built with 4-wide AVX when the
+// compiler targets it (-mavx, -mavx2 or /arch:AVX2), otherwise 2-wide SSE2,
+// otherwise plain loops. Distances are compared squared against radius2, so
+// no sqrt is taken.
+
+  // index of the first candidate within the radius, or -1
+int firstWithinRadius(const double* xs, const double* ys, int n, double x, double y, double radius2);
+
+  // writes the indices of every candidate within the radius to out, in order, and returns how many
+int filterWithinRadius(const double* xs, const double* ys, int n, double x, double y, double radius2, int* out);
+
+  // index of the closest candidate whose squared distance is <= bestDistance2, or -1. On a tie the
+  // later candidate wins. bestDistance2 is lowered to the winner's squared distance.
+int nearestWithinRadius(const double* xs, const double* ys, int n, double x, double y, double& bestDistance2);
+
+const char* distanceKernelName();	//"avx", "sse2" or "scalar"
+
+#endif // DISTANCEKERNELS_H_
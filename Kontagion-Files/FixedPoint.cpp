@@ -0,0 +1,38 @@
+#include "FixedPoint.h"
+
+#ifdef KONTAGION_CHECK_FIXED_POINT
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+
+namespace
+{
+    std::atomic<long> s_checks(0);
+    std::atomic<long> s_mismatches(0);
+    std::atomic<std::int64_t> s_maxError(0);    // in fixed-point units
+}
+
+void checkFixedStep(double fromX, double fromY, int degrees, int units, Fixed x, Fixed y)
+{
+    const double PI = 4 * atan(1);
+    double expectedX = (fromX + units * cos(degrees*1.0 / 360 * 2 * PI));
+    double expectedY = (fromY + units * sin(degrees*1.0 / 360 * 2 * PI));
+    std::int64_t error = std::max(std::llabs(std::int64_t(x) - toFixed(expectedX)),
+                                  std::llabs(std::int64_t(y) - toFixed(expectedY)));
+    s_checks++;
+    if (error > 1)
+        s_mismatches++;
+    std::int64_t seen = s_maxError;
+    while (error > seen && !s_maxError.compare_exchange_weak(seen, error))
+        ;
+}
+
+FixedPointCheckStats fixedPointCheckStats()
+{
+    FixedPointCheckStats stats;
+    stats.checks = s_checks;
+    stats.mismatches = s_mismatches;
+    stats.maxError = fromFixed(static_cast<Fixed>(s_maxError));
+    return stats;
+}
+#endif
@@ -0,0 +1,195 @@
+#ifndef FIXEDPOINT_H_
+#define FIXEDPOINT_H_
+
+#include <cstdint>
+#include <cmath>
+
+  // Positions are kept in 16.16 fixed point: an int32 holding 1/65536ths of a
+  // unit.  Moves step along per-degree unit vectors held in 2.30 fixed point,
+  // so moving is pure integer math and comes out the same on every compiler
+  // and C library.
+
+using Fixed = std::int32_t;
+
+const int FIXED_FRACTION_BITS = 16;
+const Fixed FIXED_ONE = Fixed(1) << FIXED_FRACTION_BITS;
+
+const int UNIT_FRACTION_BITS = 30;
+
+struct UnitVector
+{
+    std::int32_t x;
+    std::int32_t y;
+};
+
+inline Fixed toFixed(double v)
+{
+    return static_cast<Fixed>(std::floor(v * FIXED_ONE + 0.5));  // nearest, halves round up
+}
+
+inline double fromFixed(Fixed f)
+{
+    return f * (1.0 / FIXED_ONE);
+}
+
+  // The per-degree table is generated at compile time, so no cos or sin runs
+  // at all and every build gets the same bits.  Each entry is the Taylor
+  // series of its angle folded into 0-45 degrees, which puts the four axis
+  // directions exactly on the axes.
+
+namespace unit_table_detail
+{
+    constexpr double PI = 3.14159265358979323846;
+
+    constexpr double sinTaylor(double x)
+    {
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 12; n++)
+        {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double cosTaylor(double x)
+    {
+        double term = 1;
+        double sum = 1;
+        for (int n = 1; n < 12; n++)
+        {
+            term *= -x * x / ((2 * n - 1) * (2 * n));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr std::int32_t toUnitFixed(double v)
+    {
+        double scaled = v * double(std::int64_t(1) << UNIT_FRACTION_BITS) + 0.5;
+        std::int64_t whole = static_cast<std::int64_t>(scaled);   // truncates toward zero
+        if (whole > scaled)     // floor for negative values
+            whole--;
+        return static_cast<std::int32_t>(whole);
+    }
+
+    struct UnitTable
+    {
+        UnitVector vectors[360];
+    };
+
+    constexpr UnitTable makeUnitTable()
+    {
+        UnitTable table = {};
+        for (int d = 0; d < 360; d++)
+        {
+            int quadrant = d / 90;
+            int within = d % 90;
+            double c = 0;
+            double s = 0;
+            if (within <= 45)
+            {
+                c = cosTaylor(within * PI / 180);
+                s = sinTaylor(within * PI / 180);
+            }
+            else
+            {
+                c = sinTaylor((90 - within) * PI / 180);
+                s = cosTaylor((90 - within) * PI / 180);
+            }
+            double x = quadrant == 0 ? c : quadrant == 1 ? -s : quadrant == 2 ? -c : s;
+            double y = quadrant == 0 ? s : quadrant == 1 ? c : quadrant == 2 ? -s : -c;
+            table.vectors[d].x = toUnitFixed(x);
+            table.vectors[d].y = toUnitFixed(y);
+        }
+        return table;
+    }
+
+    inline constexpr UnitTable UNIT_TABLE = makeUnitTable();
+
+    static_assert(UNIT_TABLE.vectors[0].x == (1 << UNIT_FRACTION_BITS) && UNIT_TABLE.vectors[0].y == 0, "right");
+    static_assert(UNIT_TABLE.vectors[90].x == 0 && UNIT_TABLE.vectors[90].y == (1 << UNIT_FRACTION_BITS), "up");
+    static_assert(UNIT_TABLE.vectors[180].x == -(1 << UNIT_FRACTION_BITS) && UNIT_TABLE.vectors[180].y == 0, "left");
+    static_assert(UNIT_TABLE.vectors[60].x == (1 << (UNIT_FRACTION_BITS - 1)), "cos 60 is one half");
+}
+
+  // Unit vector for a direction in degrees; any int is accepted.
+inline const UnitVector& unitVector(int degrees)
+{
+    degrees %= 360;
+    if (degrees < 0)
+        degrees += 360;
+    return unit_table_detail::UNIT_TABLE.vectors[degrees];
+}
+
+  // units * the unit vector's component, in 16.16 and rounded to nearest.
+inline Fixed scaleUnit(std::int32_t component, int units)
+{
+    const int SHIFT = UNIT_FRACTION_BITS - FIXED_FRACTION_BITS;
+    return static_cast<Fixed>((std::int64_t(component) * units + (std::int64_t(1) << (SHIFT - 1))) >> SHIFT);
+}
+
+inline void stepFixed(Fixed& x, Fixed& y, int degrees, int units)
+{
+    const UnitVector& u = unitVector(degrees);
+    x += scaleUnit(u.x, units);
+    y += scaleUnit(u.y, units);
+}
+
+  // The offset of a point units away in a direction, for placing things on a
+  // circle around a center.
+inline void polarOffset(int degrees, int units, double& dx, double& dy)
+{
+    const UnitVector& u = unitVector(degrees);
+    dx = fromFixed(scaleUnit(u.x, units));
+    dy = fromFixed(scaleUnit(u.y, units));
+}
+
+  // The direction from the origin to (dx, dy) in whole degrees, from -179 to
+  // 180, truncated toward zero as converting atan2's result to int would.
+  // The angle is found by binary search over the unit table, comparing
+  // cross products in 64-bit integers, so it is the same in every build; a
+  // point lying on a table direction gives exactly that direction.
+inline int degreesToward(Fixed dx, Fixed dy)
+{
+    std::int64_t ax = dx < 0 ? -std::int64_t(dx) : dx;
+    std::int64_t ay = dy < 0 ? -std::int64_t(dy) : dy;
+    if (ax == 0 && ay == 0)
+        return 0;
+
+      // Largest whole degree at or below the angle of (ax, ay), 0 to 90
+    int low = 0;
+    int high = 90;
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+        const UnitVector& u = unit_table_detail::UNIT_TABLE.vectors[mid];
+        if (ay * u.x >= ax * u.y)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    const UnitVector& u = unit_table_detail::UNIT_TABLE.vectors[low];
+    bool exact = (ay * u.x == ax * u.y);
+
+    int degrees = dx >= 0 ? low : 180 - (exact ? low : low + 1);
+    return dy < 0 ? -degrees : degrees;
+}
+
+#ifdef KONTAGION_CHECK_FIXED_POINT
+  // Compatibility mode: every fixed-point step is also done the old way, in
+  // doubles with cos and sin, and compared.  Steps that land more than one
+  // fixed-point unit apart are counted as mismatches.
+struct FixedPointCheckStats
+{
+    long checks;
+    long mismatches;
+    double maxError;    // in units
+};
+
+void checkFixedStep(double fromX, double fromY, int degrees, int units, Fixed x, Fixed y);
+FixedPointCheckStats fixedPointCheckStats();
+#endif
+
+#endif // FIXEDPOINT_H_
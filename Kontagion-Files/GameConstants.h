@@ -1,9 +1,6 @@
 #ifndef GAMECONSTANTS_H_
 #define GAMECONSTANTS_H_
 
-#include <random>
-#include <utility>
-
 // image IDs for the game objects
 
 const int IID_PLAYER                =  0;
@@ -19,6 +16,34 @@ const int IID_RESTORE_HEALTH_GOODIE =  9;
 const int IID_EXTRA_LIFE_GOODIE     = 10;
 const int IID_FUNGUS                = 11;
 
+  // the file each frame of each image is drawn from
+
+struct SpriteInfo
+{
+    int         imageID;
+    int         frameNum;
+    const char* tgaFileName;
+};
+
+const SpriteInfo SPRITE_INFO[] = {
+    { IID_PLAYER               , 0, "socrates.tga" },
+    { IID_SALMONELLA           , 0, "salmonella1.tga" },
+    { IID_SALMONELLA           , 1, "salmonella2.tga" },
+    { IID_ECOLI                , 0, "ecoli1.tga" },
+    { IID_ECOLI                , 1, "ecoli2.tga" },
+    { IID_SPRAY                , 0, "water1.tga" },
+    { IID_SPRAY                , 1, "water2.tga" },
+    { IID_SPRAY                , 2, "water3.tga" },
+    { IID_FLAME                , 0, "explosion.tga" },
+    { IID_PIT                  , 0, "hole.tga" },
+    { IID_FLAME_THROWER_GOODIE , 0, "flamethrow.tga" },
+    { IID_RESTORE_HEALTH_GOODIE, 0, "health.tga" },
+    { IID_EXTRA_LIFE_GOODIE    , 0, "life.tga" },
+    { IID_FUNGUS               , 0, "fungus.tga" },
+    { IID_DIRT                 , 0, "dirt.tga" },
+    { IID_FOOD                 , 0, "pizza.tga" },
+};
+
 // sounds
 
 const int SOUND_PLAYER_DIE      =  0;
@@ -36,6 +61,38 @@ const int SOUND_BACTERIUM_BORN  = 11;
 
 const int SOUND_NONE            = -1;
 
+  // The file each sound plays, and how it competes when many start at once.
+  // A higher priority wins a place among a tick's sounds and keeps its voice
+  // in the mixer when others want it; no sound has more than maxVoices copies
+  // playing at a time.
+
+struct SoundInfo
+{
+    int         soundID;
+    const char* fileName;
+    int         priority;
+    int         maxVoices;
+};
+
+const SoundInfo SOUND_INFO[] = {
+    { SOUND_PLAYER_DIE     , "die.wav"     , 9, 1 },
+    { SOUND_FINISHED_LEVEL , "finished.wav", 9, 1 },
+    { SOUND_THEME          , "theme.wav"   , 8, 1 },
+    { SOUND_PLAYER_HURT    , "ouch.wav"    , 7, 1 },
+    { SOUND_GOT_GOODIE     , "goodie.wav"  , 6, 2 },
+    { SOUND_PLAYER_FIRE    , "flame.wav"   , 5, 1 },
+    { SOUND_PLAYER_SPRAY   , "squirt.wav"  , 5, 2 },
+    { SOUND_ECOLI_DIE      , "scream.wav"  , 4, 3 },
+    { SOUND_SALMONELLA_DIE , "scream.wav"  , 4, 3 },
+    { SOUND_BACTERIUM_BORN , "born.wav"    , 3, 2 },
+    { SOUND_ECOLI_HURT     , "hurt.wav"    , 2, 2 },
+    { SOUND_SALMONELLA_HURT, "hurt.wav"    , 2, 2 },
+};
+
+  // the most different sounds one tick may start
+
+const int MAX_SOUNDS_PER_TICK = 4;
+
 
 // keys the user can hit
 
@@ -71,17 +128,4 @@ const int GWSTATUS_FINISHED_LEVEL = 3;
 const int GWSTATUS_LEVEL_ERROR    = 4;
 
 
-  // Return a uniformly distributed random int from min to max, inclusive
-
-inline
-int randInt(int min, int max)
-{
-    if (max < min)
-        std::swap(max, min);
-    static std::random_device rd;
-    static std::default_random_engine generator(rd());
-    std::uniform_int_distribution<> distro(min, max);
-    return distro(generator);
-}
-
 #endif // GAMECONSTANTS_H_
@@ -4,12 +4,18 @@
 #include "GameConstants.h"
 #include "GraphObject.h"
 #include "SoundFX.h"
+#include "DeviceAudioSink.h"
 #include "SpriteManager.h"
+#include "TaskScheduler.h"
+#include "AssetPack.h"
 #include <string>
 #include <map>
 #include <utility>
 #include <cstdlib>
 #include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cmath>
 using namespace std;
 
 /*
@@ -33,6 +39,7 @@ newSpriteHeight = PixelHeight * NumPixels
 static const int WINDOW_WIDTH = 768; //1024;
 static const int WINDOW_HEIGHT = 768;
 
+static const double FIELD_OF_VIEW = 45.0;    // degrees, vertically
 static const int PERSPECTIVE_NEAR_PLANE = 4;
 static const int PERSPECTIVE_FAR_PLANE  = 22;
 
@@ -41,67 +48,97 @@ static const double FONT_SCALEDOWN = 760.0;
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
 
-static const int MS_PER_FRAME = 5;
+  // The world ticks at a fixed rate however fast frames are drawn.  After a
+  // stall (a slow frame, a dragged window) at most MAX_TICKS_PER_FRAME ticks
+  // run to catch up and the rest of the backlog is dropped, so a machine
+  // that cannot keep up slows the game down instead of falling further
+  // behind with every frame.
+static const int MAX_TICKS_PER_FRAME = 5;
 
-struct SpriteInfo
-{
-    int         imageID;
-    int         frameNum;
-    std::string tgaFileName;
-};
+  // Frames are drawn from the idle callback.  Where buffer swaps wait for the
+  // display they pace it; where they don't, the callback sleeps until the
+  // next frame, or the next tick if ticks come faster, instead of spinning.
+static const int MAX_FRAMES_PER_SECOND = 120;
 
 static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void outputStrokeCentered(double y, double z, const char* str);
 
 enum GameController::GameControllerState : int {
-    welcome, init, makemove, animate, contgame, finishedlevel, cleanup,
+    welcome, init, play, contgame, finishedlevel, cleanup,
     gameover, prompt, quit, not_applicable
 };
 
 void GameController::initDrawersAndSounds()
 {
-    SpriteInfo drawers[] = {
-	{ IID_PLAYER               , 0, "socrates.tga" },
-	{ IID_SALMONELLA           , 0, "salmonella1.tga" },
-	{ IID_SALMONELLA           , 1, "salmonella2.tga" },
-	{ IID_ECOLI                , 0, "ecoli1.tga" },
-	{ IID_ECOLI                , 1, "ecoli2.tga" },
-	{ IID_SPRAY                , 0, "water1.tga" },
-	{ IID_SPRAY                , 1, "water2.tga" },
-	{ IID_SPRAY                , 2, "water3.tga" },
-	{ IID_FLAME                , 0, "explosion.tga" },
-	{ IID_PIT                  , 0, "hole.tga" },
-	{ IID_FLAME_THROWER_GOODIE , 0, "flamethrow.tga" },
-	{ IID_RESTORE_HEALTH_GOODIE, 0, "health.tga" },
-	{ IID_EXTRA_LIFE_GOODIE    , 0, "life.tga" },
-	{ IID_FUNGUS               , 0, "fungus.tga" },
-	{ IID_DIRT                 , 0, "dirt.tga" },
-	{ IID_FOOD                 , 0, "pizza.tga" },
-    };
-
-    SoundMapType::value_type sounds[] = {
-	make_pair(SOUND_PLAYER_FIRE    , "flame.wav"),
-	make_pair(SOUND_SALMONELLA_HURT, "hurt.wav"),
-	make_pair(SOUND_ECOLI_HURT     , "hurt.wav"),
-	make_pair(SOUND_PLAYER_DIE     , "die.wav"),
-	make_pair(SOUND_GOT_GOODIE     , "goodie.wav"),
-	make_pair(SOUND_FINISHED_LEVEL , "finished.wav"),
-	make_pair(SOUND_PLAYER_SPRAY   , "squirt.wav"),
-	make_pair(SOUND_ECOLI_DIE      , "scream.wav"),
-	make_pair(SOUND_SALMONELLA_DIE , "scream.wav"),
-	make_pair(SOUND_THEME          , "theme.wav"),
-	make_pair(SOUND_PLAYER_HURT    , "ouch.wav"),
-	make_pair(SOUND_BACTERIUM_BORN , "born.wav")
-    };
-
     string path = m_gw->assetPath();
-    for (const SpriteInfo& d : drawers)
+
+      // A prebaked pack (see tools/assetpack.cpp) holds the finished atlas and
+      // the sounds in one mapped file; without one, the frames are read and
+      // decoded from the loose files on every core.  Either way only the
+      // upload, which needs the GL context, runs here.
+    SpriteAtlas::LoadTimes times;
+    string error;
+    auto start = chrono::steady_clock::now();
+    if (m_assetPack != nullptr)
     {
-        if (!m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum))
+        if (!m_spriteManager.loadSprites(*m_assetPack, times, error))
+        {
+            cout << error << endl;
+            exit(1);
+        }
+        double total = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Sprites loaded from " << ASSET_PACK_FILE << " in " << total << " ms:"
+             << " io " << times.io << ", upload " << times.upload << endl;
+    }
+    else
+    {
+        TaskScheduler loaders(max(1, static_cast<int>(thread::hardware_concurrency())));
+        if (!m_spriteManager.loadSprites(path, loaders, times, error))
+        {
+            cout << error << endl;
             exit(1);
+        }
+        double total = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Sprites loaded in " << total << " ms on " << loaders.threadCount() << " threads:"
+             << " io " << times.io << ", decode " << times.decode << ", pack " << times.pack
+             << ", mipmaps " << times.mipmaps << ", upload " << times.upload << endl;
     }
-    for (const auto& s : sounds)
-        m_soundMap[s.first] = s.second;
+
+      // The mix is recorded if asked, and otherwise goes to the sound device.
+      // SoundFX plays the loose files only when the mix isn't heard, and with
+      // nowhere to send the mix the mixer isn't started at all.
+    unique_ptr<AudioSink> sink;
+    if (!m_soundFile.empty())
+    {
+        unique_ptr<WavFileAudioSink> file(new WavFileAudioSink(m_soundFile, AudioMixer::SAMPLE_RATE));
+        if (file->isOpen())
+            sink = move(file);
+        else
+            cout << "Cannot write " << m_soundFile << endl;
+    }
+    bool onDevice = false;
+    if (sink == nullptr)
+    {
+        sink = DeviceAudioSink::open(AudioMixer::SAMPLE_RATE);
+        onDevice = (sink != nullptr);
+    }
+    if (!onDevice)
+    {
+        for (const SoundInfo& s : SOUND_INFO)
+            m_soundMap[s.soundID] = path + s.fileName;
+    }
+
+      // Every clip is decoded here, once, so playing one later costs the
+      // game thread no more than a queue push.
+    if (sink != nullptr)
+    {
+        m_audio.reset(new AudioMixer(move(sink)));
+        int failed = m_audio->loadGameSounds(path, m_assetPack.get());
+        if (failed > 0)
+            cout << failed << " sound(s) could not be loaded" << endl;
+        m_audio->start();
+    }
+    m_assetPack.reset();     // everything in it has been uploaded or decoded
 }
 
 static void doSomethingCallback()
@@ -109,6 +146,12 @@ static void doSomethingCallback()
     Game().doSomething();
 }
 
+static void idleCallback()
+{
+    Game().waitForNextFrame();
+    Game().doSomething();
+}
+
 static void reshapeCallback(int w, int h)
 {
     Game().reshape(w, h);
@@ -124,12 +167,6 @@ static void specialKeyboardEventCallback(int key, int x, int y)
     Game().specialKeyboardEvent(key, x, y);
 }
 
-static void timerFuncCallback(int)
-{
-    Game().doSomething();
-    glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
-}
-
 void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
 {
     gw->setController(this);
@@ -137,8 +174,14 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
     setGameState(welcome);
     m_lastKeyHit = INVALID_KEY;
     m_singleStep = false;
-    m_curIntraFrameTick = 0;
+    m_statTextChanged = true;
+    m_statTextFallbackReported = false;
     m_playerWon = false;
+    m_windowTitle = windowTitle;
+    m_lastStatsTime = 0;
+    m_ticksSinceStats = 0;
+    m_framesSinceStats = 0;
+    m_nextFrame = chrono::steady_clock::now();
 
     glutInit(&argc, argv);
 
@@ -153,11 +196,26 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
     glutSpecialFunc(specialKeyboardEventCallback);
     glutReshapeFunc(reshapeCallback);
     glutDisplayFunc(doSomethingCallback);
-    glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
+    glutIdleFunc(idleCallback);
 
     glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
     glutMainLoop();
     delete m_gw;
+    m_audio.reset();    // joins the mixer thread and finishes the sound file
+}
+
+void GameController::waitForNextFrame()
+{
+    double frameLength = min(1.0 / MAX_FRAMES_PER_SECOND, 1.0 / m_ticksPerSecond);
+    auto now = chrono::steady_clock::now();
+    if (now < m_nextFrame)
+    {
+        this_thread::sleep_until(m_nextFrame);
+        now = chrono::steady_clock::now();
+    }
+      // After a stall, start counting from now rather than rushing out the
+      // frames that were missed
+    m_nextFrame = max(m_nextFrame + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(frameLength)), now);
 }
 
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
@@ -192,13 +250,20 @@ void GameController::playSound(int soundID)
 {
     if (soundID == SOUND_NONE)
     {
-        SoundFX().abortClip();
+        if (m_audio != nullptr)
+            m_audio->stopAll();
+        if (!m_soundMap.empty())
+            SoundFX().abortClip();
         return;
     }
 
+    if (m_audio != nullptr)
+        m_audio->play(soundID);
+    if (m_soundMap.empty())     // the mixer is playing on the sound device
+        return;
     SoundMapType::const_iterator p = m_soundMap.find(soundID);
     if (p != m_soundMap.end())
-        SoundFX().playClip(m_gw->assetPath() + p->second);
+        SoundFX().playClip(p->second);
 }
 
 void GameController::setGameState(GameControllerState s)
@@ -234,7 +299,8 @@ void GameController::doSomething()
         case init:
             {
                 int status = m_gw->init();
-                SoundFX().abortClip();
+                playSound(SOUND_NONE);
+                m_gw->submitSounds();
                 if (status == GWSTATUS_PLAYER_WON)
                 {
                     m_playerWon = true;
@@ -247,40 +313,47 @@ void GameController::doSomething()
                         "Press Enter to quit...");
                 }
                 else
-                    setGameState(makemove);
-            }
-            break;
-        case makemove:
-            m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-            m_nextStateAfterAnimate = not_applicable;
-            {
-                int status = m_gw->move();
-                if (status == GWSTATUS_PLAYER_DIED)
                 {
-                      // animate one last frame so the player can see what happened
-                    m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
-                }
-                else if (status == GWSTATUS_FINISHED_LEVEL)
-                {
-                    m_gw->advanceToNextLevel();
-                      // animate one last frame so the player can see what happened
-                    m_nextStateAfterAnimate = finishedlevel;
+                      // time spent before play, say in a prompt, is not owed as ticks
+                    m_lastClock = chrono::steady_clock::now();
+                    m_unsimulated = 0;
+                    m_nextStateAfterPlay = not_applicable;
+                    setGameState(play);
                 }
             }
-            setGameState(animate);
             break;
-        case animate:
-            displayGamePlay();
-            if (m_curIntraFrameTick-- <= 0)
+        case play:
             {
-                if (m_nextStateAfterAnimate != not_applicable)
-                    setGameState(m_nextStateAfterAnimate);
+                auto now = chrono::steady_clock::now();
+                m_unsimulated += chrono::duration<double>(now - m_lastClock).count();
+                m_lastClock = now;
+                double tickLength = 1.0 / m_ticksPerSecond;
+                int key;
+                if (m_singleStep)
+                {
+                    m_unsimulated = 0;
+                    if (getLastKey(key))
+                        tick();
+                }
                 else
                 {
-                    int key;
-                    if (!m_singleStep  ||  getLastKey(key))
-                        setGameState(makemove);
+                    for (int ticks = 0; m_unsimulated >= tickLength  &&  m_nextStateAfterPlay == not_applicable; ticks++)
+                    {
+                        if (ticks == MAX_TICKS_PER_FRAME)
+                        {
+                            m_unsimulated = 0;
+                            break;
+                        }
+                        m_unsimulated -= tickLength;
+                        tick();
+                    }
                 }
+                  // Once a tick ends the level, draw where it left everything
+                  // so the player can see what happened
+                bool ended = (m_nextStateAfterPlay != not_applicable);
+                displayGamePlay(ended || m_singleStep ? 1 : min(m_unsimulated / tickLength, 1.0));
+                if (ended)
+                    setGameState(m_nextStateAfterPlay);
             }
             break;
         case contgame:
@@ -313,13 +386,28 @@ void GameController::doSomething()
             }
             break;
         case quit:
-            SoundFX().abortClip();
+            playSound(SOUND_NONE);
             glutLeaveMainLoop();
             break;
     }
 }
 
-void GameController::displayGamePlay()
+void GameController::tick()
+{
+    GraphObject::startTick(m_gw->graphObjects());
+    int status = m_gw->move();
+    m_gw->submitSounds();
+    m_ticksSinceStats++;
+    if (status == GWSTATUS_PLAYER_DIED)
+        m_nextStateAfterPlay = (m_gw->isGameOver() ? gameover : contgame);
+    else if (status == GWSTATUS_FINISHED_LEVEL)
+    {
+        m_gw->advanceToNextLevel();
+        m_nextStateAfterPlay = finishedlevel;
+    }
+}
+
+void GameController::displayGamePlay(double alpha)
 {
     glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
     glLoadIdentity();
@@ -333,18 +421,54 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
-    GraphObject::drawAllObjects(
-        [=](int imageID, int animationNumber, double x, double y, int angle, double size)
+      // Dirt, food and pits come from a cached layer beneath everything else,
+      // rerecorded only when one of them has come or gone
+    GraphObjectRegistry& objects = m_gw->graphObjects();
+    m_spriteManager.drawStaticLayer(objects.staticVersion(), [&]()
         {
-            int frame = animationNumber % m_spriteManager.getNumFrames(imageID);
-            m_spriteManager.plotSprite(imageID, frame, x, y, angle, size);
+            GraphObject::drawStaticObjects(objects,
+                [=](int imageID, int animationNumber, double x, double y, int angle, double size, int depth)
+                {
+                    m_spriteManager.queueStaticSprite(imageID, animationNumber, depth, x, y, angle, size);
+                });
         });
+    GraphObject::drawAllObjects(objects,
+        [=](int imageID, int animationNumber, double x, double y, int angle, double size, int depth)
+        {
+            m_spriteManager.queueSprite(imageID, animationNumber, depth, x, y, angle, size);
+        }, alpha);
+    m_spriteManager.drawQueuedSprites();
+    showRenderStats();
 
-    drawScoreAndLives(m_gameStatText);
+    drawStatLine();
 
-    SpriteManager::drawCircle(VIEW_WIDTH / 2, VIEW_HEIGHT / 2, VIEW_WIDTH / 2 + SPRITE_WIDTH, 100);
+    m_spriteManager.drawRing(VIEW_WIDTH / 2, VIEW_HEIGHT / 2, VIEW_WIDTH / 2 + SPRITE_WIDTH, 100);
 
     glutSwapBuffers();
+    m_framesSinceStats++;
+}
+
+  // Once a second, put the tick and frame rates and what the last frame
+  // drew in the title bar
+void GameController::showRenderStats()
+{
+    int now = glutGet(GLUT_ELAPSED_TIME);
+    if (now - m_lastStatsTime < 1000)
+        return;
+    double seconds = (now - m_lastStatsTime) / 1000.0;
+    m_lastStatsTime = now;
+
+    const SpriteBatch::Stats& stats = m_spriteManager.lastFrameStats();
+    ostringstream oss;
+    oss.setf(ios::fixed);
+    oss.precision(0);
+    oss << m_windowTitle << " - " << m_ticksSinceStats / seconds << " ticks/s, "
+        << m_framesSinceStats / seconds << " frames/s - " << stats.sprites << " sprites, "
+        << stats.drawCalls << " draw calls, " << stats.vertices << " vertices per frame, "
+        << m_spriteManager.staticLayerStats().sprites << " cached";
+    glutSetWindowTitle(oss.str().c_str());
+    m_ticksSinceStats = 0;
+    m_framesSinceStats = 0;
 }
 
 void GameController::reshape (int w, int h)
@@ -353,14 +477,38 @@ void GameController::reshape (int w, int h)
     glMatrixMode (GL_PROJECTION);
     glLoadIdentity ();
 #ifdef _MSC_VER
-    gluPerspective(45.0, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
+    gluPerspective(FIELD_OF_VIEW, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
 #else
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-    gluPerspective(45.0, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
+    gluPerspective(FIELD_OF_VIEW, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
 #pragma GCC diagnostic pop
 #endif
     glMatrixMode (GL_MODELVIEW);
+    buildStatText(w, h);
+}
+
+  // The glyphs are drawn at the size the stats line appears at in a window
+  // of this height.  Building them draws into the back buffer, which the
+  // next frame clears.  A window too small to build in, or glyphs too big
+  // for their texture, leave the stats line drawn as strokes until the
+  // window changes size again.
+void GameController::buildStatText(int windowWidth, int windowHeight)
+{
+    bool built = false;
+    if (windowWidth >= GlyphText::TEXTURE_WIDTH  &&  windowHeight >= GlyphText::TEXTURE_HEIGHT)
+    {
+        double pixelsPerUnit = windowHeight / (2 * -SCORE_Z * tan(FIELD_OF_VIEW / 2 * 3.14159265358979 / 180)) / FONT_SCALEDOWN;
+        built = m_statText.build(GLUT_STROKE_ROMAN, static_cast<float>(pixelsPerUnit));
+    }
+    else
+        m_statText.release();
+    if (!built  &&  !m_statTextFallbackReported)
+    {
+        cout << "Stats line glyphs cannot be built at this window size; drawing them as strokes" << endl;
+        m_statTextFallbackReported = true;
+    }
+    m_statTextChanged = true;
 }
 
 static void doOutputStroke(double x, double y, double z, double size, const char* str, bool centered)
@@ -402,14 +550,20 @@ static void drawPrompt(string mainMessage, string secondMessage)
     glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+  // The stats line from the glyph texture, in a color that wanders a little
+  // each frame
+void GameController::drawStatLine()
 {
-    static int RATE = 1;
+    static const int RATE = 1;
     static GLfloat rgb[3] =
         { static_cast<GLfloat>(.6), static_cast<GLfloat>(.6), static_cast<GLfloat>(.6) };
+    static unsigned int flicker = 2463534242u;   // xorshift; the wander needs no better randomness
     for (int k = 0; k < 3; k++)
     {
-        double strength = rgb[k] + randInt(-RATE, RATE) / 100.0;
+        flicker ^= flicker << 13;
+        flicker ^= flicker >> 17;
+        flicker ^= flicker << 5;
+        double strength = rgb[k] + (static_cast<int>(flicker % (2 * RATE + 1)) - RATE) / 100.0;
         if (strength < .6)
             strength = .6;
         else if (strength > 1.0)
@@ -417,5 +571,22 @@ static void drawScoreAndLives(string gameStatText)
         rgb[k] = static_cast<GLfloat>(strength);
     }
     glColor3f(rgb[0], rgb[1], rgb[2]);
-    outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str());
+
+    if (!m_statText.isBuilt())
+    {
+        outputStrokeCentered(SCORE_Y, SCORE_Z, m_gameStatText.c_str());
+        return;
+    }
+    if (m_statTextChanged)
+    {
+        m_statText.setText(m_gameStatText.c_str());
+        m_statTextChanged = false;
+    }
+    GLfloat scale = static_cast<GLfloat>(1 / FONT_SCALEDOWN);
+    glPushMatrix();
+    glLoadIdentity();
+    glTranslatef(static_cast<GLfloat>(-m_statText.width() / FONT_SCALEDOWN / 2), static_cast<GLfloat>(SCORE_Y), static_cast<GLfloat>(SCORE_Z));
+    glScalef(scale, scale, scale);
+    m_statText.draw();
+    glPopMatrix();
 }
@@ -1,23 +1,31 @@
 #ifndef GAMECONTROLLER_H_
 #define GAMECONTROLLER_H_
 
+#include "GameHost.h"
 #include "SpriteManager.h"
+#include "AudioMixer.h"
+#include "AssetPack.h"
+#include "GlyphText.h"
 #include <string>
 #include <map>
 #include <iostream>
 #include <sstream>
-
-const int INVALID_KEY = 0;
+#include <memory>
+#include <chrono>
 
 class GraphObject;
 class GameWorld;
 
-class GameController
+class GameController : public GameHost
 {
   public:
+      // The pace the game was tuned at: one tick for every three 5 ms timer
+      // callbacks, about 66 a second
+    static const int DEFAULT_TICKS_PER_SECOND = 1000 / (3 * 5);
+
     void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle);
 
-    bool getLastKey(int& value)
+    virtual bool getLastKey(int& value)
     {
         if (m_lastKeyHit != INVALID_KEY)
         {
@@ -28,20 +36,46 @@ class GameController
         return false;
     }
 
-    void playSound(int soundID);
+    virtual void playSound(int soundID);
+
+      // Record the mixed sound to this .wav file rather than discarding it.
+      // Only before run.
+    void setSoundFile(std::string fileName)
+    {
+        m_soundFile = fileName;
+    }
+
+      // Load the sprites and sounds from this open pack instead of the loose
+      // files in the world's asset directory.  Only before run; the pack is
+      // closed once everything is loaded.
+    void setAssetPack(std::unique_ptr<AssetPack> pack)
+    {
+        m_assetPack = std::move(pack);
+    }
+
+      // How many times a second the world ticks, whatever the frame rate.
+      // Only before run.
+    void setTickRate(int ticksPerSecond)
+    {
+        if (ticksPerSecond > 0)
+            m_ticksPerSecond = ticksPerSecond;
+    }
 
-    void setGameStatText(std::string text)
+      // The world calls this only when the text has changed
+    virtual void setGameStatText(std::string text)
     {
         m_gameStatText = text;
+        m_statTextChanged = true;
     }
 
     void doSomething();
+    void waitForNextFrame();    // sleeps unless a frame or tick is already due
 
     void reshape(int w, int h);
     void keyboardEvent(unsigned char key, int x, int y);
     void specialKeyboardEvent(int key, int x, int y);
 
-    void quitGame();
+    virtual void quitGame();
 
       // Meyers singleton pattern
     static GameController& getInstance()
@@ -56,25 +90,42 @@ private:
     GameWorld*          m_gw;
     GameControllerState m_gameState;
     GameControllerState m_nextStateAfterPrompt;
-    GameControllerState m_nextStateAfterAnimate;
+    GameControllerState m_nextStateAfterPlay;
     int         m_lastKeyHit;
     bool        m_singleStep;
     std::string m_gameStatText;
+    bool        m_statTextChanged;
+    GlyphText   m_statText;         // m_gameStatText, laid out; rebuilt for each window size
+    bool        m_statTextFallbackReported;
     std::string m_mainMessage;
     std::string m_secondMessage;
-    int         m_curIntraFrameTick;
+    int         m_ticksPerSecond = DEFAULT_TICKS_PER_SECOND;
+    double      m_unsimulated;      // seconds of play the world has yet to tick through
+    std::chrono::steady_clock::time_point m_lastClock;
+    std::chrono::steady_clock::time_point m_nextFrame;  // when the idle callback next draws
     using SoundMapType = std::map<int, std::string>;
     using DrawMapType =  std::map<int, std::string>;
-    SoundMapType  m_soundMap;
+    SoundMapType  m_soundMap;       // full paths, for SoundFX; empty when the mix plays on the device
+    std::unique_ptr<AudioMixer> m_audio;        // null when there is nowhere to send the mix
+    std::unique_ptr<AssetPack>  m_assetPack;    // null to load the loose files
+    std::string   m_soundFile;
     bool          m_playerWon;
     SpriteManager m_spriteManager;
+    std::string   m_windowTitle;
+    int           m_lastStatsTime;  // ms, when the title last showed render stats
+    int           m_ticksSinceStats;
+    int           m_framesSinceStats;
 
     void setGameState(GameControllerState s);
     void setGameStateAfterPrompting(GameControllerState s,
                             std::string mainMessage, std::string secondMessage);
 
     void initDrawersAndSounds();
-    void displayGamePlay();
+    void tick();
+    void displayGamePlay(double alpha);
+    void buildStatText(int windowWidth, int windowHeight);
+    void drawStatLine();
+    void showRenderStats();
 };
 
 inline GameController& Game()
@@ -0,0 +1,25 @@
+#ifndef GAMEHOST_H_
+#define GAMEHOST_H_
+
+#include <string>
+
+const int INVALID_KEY = 0;
+
+  // The services a GameWorld needs from whatever is driving it.  GameController
+  // provides them with GLUT and a window; HeadlessController provides them
+  // without any display so worlds can be ticked from scripts and tools.
+
+class GameHost
+{
+  public:
+    virtual ~GameHost()
+    {
+    }
+
+    virtual bool getLastKey(int& value) = 0;
+    virtual void playSound(int soundID) = 0;
+    virtual void setGameStatText(std::string text) = 0;
+    virtual void quitGame() = 0;
+};
+
+#endif // GAMEHOST_H_
@@ -1,5 +1,5 @@
 #include "GameWorld.h"
-#include "GameController.h"
+#include "GameHost.h"
 #include <string>
 #include <cstdlib>
 using namespace std;
@@ -18,10 +18,21 @@ bool GameWorld::getKey(int& value)
 
 void GameWorld::playSound(int soundID)
 {
-    m_controller->playSound(soundID);
+    m_sounds.add(soundID);
+}
+
+void GameWorld::submitSounds()
+{
+    m_sounds.submit(*m_controller);
 }
 
 void GameWorld::setGameStatText(string text)
 {
     m_controller->setGameStatText(text);
 }
+
+void GameWorld::setGameStats(const GameStats& stats)
+{
+    if (m_statLine.update(stats))
+        m_controller->setGameStatText(m_statLine.text());
+}
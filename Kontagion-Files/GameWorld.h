@@ -2,11 +2,15 @@
 #define GAMEWORLD_H_
 
 #include "GameConstants.h"
+#include "GraphObject.h"
+#include "SoundBatch.h"
+#include "StatLine.h"
 #include <string>
 
 const int START_PLAYER_LIVES = 3;
 
-class GameController;
+class GameHost;
+class TaskScheduler;
 
 class GameWorld
 {
@@ -14,7 +18,7 @@ public:
 
     GameWorld(std::string assetPath)
      : m_lives(START_PLAYER_LIVES), m_score(0), m_level(1),
-       m_controller(nullptr), m_assetPath(assetPath)
+       m_controller(nullptr), m_scheduler(nullptr), m_assetPath(assetPath)
     {
     }
 
@@ -28,8 +32,11 @@ public:
 
     void setGameStatText(std::string text);
 
+      // Passes the stats line on to the controller only when a stat changed
+    void setGameStats(const GameStats& stats);
+
     bool getKey(int& value);
-    void playSound(int soundID);
+    void playSound(int soundID);    // held until submitSounds
 
     int getLevel() const
     {
@@ -78,17 +85,47 @@ public:
         ++m_level;
     }
    
-    void setController(GameController* controller)
+    void setController(GameHost* controller)
     {
         m_controller = controller;
     }
+
+      // Plays the sounds asked for since the last call; controllers call it
+      // after every init and move.
+    void submitSounds();
+
+    const SoundBatch::Stats& soundStats() const
+    {
+        return m_sounds.stats();
+    }
+
+    GraphObjectRegistry& graphObjects()
+    {
+        return m_graphObjects;
+    }
+
+      // Threads the world may split a tick across; null ticks on the calling
+      // thread alone.  The scheduler must outlive its use by the world.
+    void setTaskScheduler(TaskScheduler* scheduler)
+    {
+        m_scheduler = scheduler;
+    }
+
+    TaskScheduler* taskScheduler() const
+    {
+        return m_scheduler;
+    }
     
 private:
     int m_lives;
     int m_score;
     int m_level;
-    GameController* m_controller;
+    GameHost*       m_controller;
+    TaskScheduler*  m_scheduler;
     std::string     m_assetPath;
+    GraphObjectRegistry m_graphObjects;
+    SoundBatch      m_sounds;
+    StatLine        m_statLine;
 };
 
 #endif // GAMEWORLD_H_
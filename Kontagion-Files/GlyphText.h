@@ -0,0 +1,221 @@
+#ifndef GLYPHTEXT_H_
+#define GLYPHTEXT_H_
+
+#include "freeglut.h"
+#include <vector>
+#include <cmath>
+
+#ifndef GL_INTENSITY
+#define GL_INTENSITY 0x8049
+#endif
+
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+  // Draws a line of text from one texture holding every printable ASCII
+  // glyph of a GLUT stroke font, so the whole line is a single textured draw
+  // instead of a stroke list per character.  The glyphs are drawn into the
+  // back buffer once, at the size they will appear on screen, and copied
+  // out.  Quads are laid out in the font's own units, so the text goes where
+  // glutStrokeCharacter would have put it under the same transform, and they
+  // are only laid out again when the text changes.
+
+class GlyphText
+{
+public:
+    static constexpr int TEXTURE_WIDTH = 512;
+    static constexpr int TEXTURE_HEIGHT = 256;
+    static constexpr int PADDING = 2;           // pixels around each glyph
+    static constexpr float ASCENT = 119.05f;    // of the GLUT stroke fonts, in font units
+    static constexpr float DESCENT = 33.33f;
+
+    GlyphText()
+     : m_texture(0), m_width(0)
+    {
+    }
+
+    ~GlyphText()
+    {
+        release();
+    }
+
+    bool isBuilt() const
+    {
+        return m_texture != 0;
+    }
+
+      // Frees the texture; the text is not drawable until built again
+    void release()
+    {
+        if (m_texture != 0)
+            glDeleteTextures(1, &m_texture);
+        m_texture = 0;
+        m_positions.clear();
+        m_texCoords.clear();
+        m_width = 0;
+    }
+
+      // Renders font's glyphs at pixelsPerUnit screen pixels per font unit,
+      // replacing any built before.  Needs the GL context and a window at
+      // least TEXTURE_WIDTH by TEXTURE_HEIGHT, and overwrites the back
+      // buffer, so call it before drawing a frame.  False, and left unbuilt,
+      // if the glyphs don't fit the texture.  Call setText again after.
+    bool build(void* font, float pixelsPerUnit)
+    {
+        release();
+        int cellHeight = static_cast<int>(std::ceil((ASCENT + DESCENT) * pixelsPerUnit)) + 2 * PADDING;
+        int x = 0;
+        int y = 0;
+        for (int c = FIRST_CHAR; c <= LAST_CHAR; c++)
+        {
+            float advance = static_cast<float>(glutStrokeWidth(font, c));
+            int cellWidth = static_cast<int>(std::ceil(advance * pixelsPerUnit)) + 2 * PADDING;
+            if (x + cellWidth > TEXTURE_WIDTH)
+            {
+                x = 0;
+                y += cellHeight;
+            }
+            if (y + cellHeight > TEXTURE_HEIGHT)
+                return false;
+
+            Glyph& g = m_glyphs[c - FIRST_CHAR];
+            g.advance = advance;
+            g.x = x;
+            g.y = y;
+            g.left = -PADDING / pixelsPerUnit;
+            g.right = g.left + cellWidth / pixelsPerUnit;
+            g.bottom = -DESCENT - PADDING / pixelsPerUnit;
+            g.top = g.bottom + cellHeight / pixelsPerUnit;
+            g.u0 = static_cast<float>(x) / TEXTURE_WIDTH;
+            g.u1 = static_cast<float>(x + cellWidth) / TEXTURE_WIDTH;
+            g.v0 = static_cast<float>(y) / TEXTURE_HEIGHT;
+            g.v1 = static_cast<float>(y + cellHeight) / TEXTURE_HEIGHT;
+            x += cellWidth;
+        }
+
+        glPushAttrib(GL_ALL_ATTRIB_BITS);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, TEXTURE_WIDTH, 0, TEXTURE_HEIGHT, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glViewport(0, 0, TEXTURE_WIDTH, TEXTURE_HEIGHT);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_TEXTURE_2D);
+        glDisable(GL_BLEND);
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glColor3f(1, 1, 1);
+        glLineWidth(1);
+        for (int c = FIRST_CHAR; c <= LAST_CHAR; c++)
+        {
+            const Glyph& g = m_glyphs[c - FIRST_CHAR];
+            glLoadIdentity();
+            glTranslatef(static_cast<GLfloat>(g.x + PADDING), static_cast<GLfloat>(g.y + PADDING + DESCENT * pixelsPerUnit), 0);
+            glScalef(pixelsPerUnit, pixelsPerUnit, 1);
+            glutStrokeCharacter(font, c);
+        }
+
+          // intensity, so the glyphs take the color they are drawn with and
+          // their coverage is their alpha
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_INTENSITY, 0, 0, TEXTURE_WIDTH, TEXTURE_HEIGHT, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopAttrib();
+        return true;
+    }
+
+      // Lays out text starting at the origin; characters the font has no
+      // glyph for are skipped.
+    void setText(const char* text)
+    {
+        m_positions.clear();
+        m_texCoords.clear();
+        float x = 0;
+        for ( ; *text != '\0'; text++)
+        {
+            int c = static_cast<unsigned char>(*text);
+            if (c < FIRST_CHAR  ||  c > LAST_CHAR)
+                continue;
+            const Glyph& g = m_glyphs[c - FIRST_CHAR];
+            if (c != ' ')
+            {
+                const float corners[4][2] = { { g.left, g.bottom }, { g.right, g.bottom }, { g.right, g.top }, { g.left, g.top } };
+                const float uvs[4][2] = { { g.u0, g.v0 }, { g.u1, g.v0 }, { g.u1, g.v1 }, { g.u0, g.v1 } };
+                for (int k = 0; k < 4; k++)
+                {
+                    m_positions.push_back(x + corners[k][0]);
+                    m_positions.push_back(corners[k][1]);
+                    m_texCoords.push_back(uvs[k][0]);
+                    m_texCoords.push_back(uvs[k][1]);
+                }
+            }
+            x += g.advance;
+        }
+        m_width = x;
+    }
+
+      // In font units, as glutStrokeLength would measure it
+    float width() const
+    {
+        return m_width;
+    }
+
+      // Draws the text in the current color under the current transform
+    void draw() const
+    {
+        if (m_positions.empty())
+            return;
+        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glEnable(GL_TEXTURE_2D);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);   // color times coverage is already in the source
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, m_positions.data());
+        glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords.data());
+        glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(m_positions.size() / 2));
+        glPopClientAttrib();
+        glPopAttrib();
+    }
+
+      // Prevent copying; the texture belongs to one GlyphText
+    GlyphText(const GlyphText&) = delete;
+    GlyphText& operator=(const GlyphText&) = delete;
+
+private:
+    static constexpr int FIRST_CHAR = ' ';
+    static constexpr int LAST_CHAR = '~';
+
+    struct Glyph
+    {
+        float advance;                      // font units
+        int   x, y;                         // of its cell in the texture, pixels
+        float left, bottom, right, top;     // the cell around the origin, font units
+        float u0, v0, u1, v1;
+    };
+
+    Glyph               m_glyphs[LAST_CHAR - FIRST_CHAR + 1];
+    GLuint              m_texture;
+    std::vector<GLfloat> m_positions;       // x, y per vertex
+    std::vector<GLfloat> m_texCoords;       // u, v per vertex
+    float               m_width;
+};
+
+#endif // GLYPHTEXT_H_
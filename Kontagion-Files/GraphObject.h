@@ -1,16 +1,61 @@
 #ifndef GRAPHOBJ_H_
 #define GRAPHOBJ_H_
 
-#include "SpriteManager.h"
 #include "GameConstants.h"
+#include "FixedPoint.h"
 
-#include <set>
+#include <vector>
 #include <cmath>
 
-const int ANIMATION_POSITIONS_PER_TICK = 1;
-
 using Direction = int;
 
+class GraphObject;
+
+  // The GraphObjects that belong to one world, by depth.  Each world owns its
+  // own registry, so several worlds can exist (and run on different threads)
+  // in one process.  Objects of a depth are kept contiguously; each object
+  // remembers its slot, so adding and removing are O(1) and removing just
+  // moves the last object of that depth into the freed slot.  Objects made
+  // static are kept apart, and the registry counts every static object added
+  // or removed, so a drawing of them can be cached until the count changes.
+
+class GraphObjectRegistry
+{
+  public:
+    static const int NUM_DEPTHS = 4;
+
+    const std::vector<GraphObject*>& objectsAtDepth(int depth) const
+    {
+        return m_graphObjects[clampDepth(depth)];
+    }
+
+    const std::vector<GraphObject*>& staticObjectsAtDepth(int depth) const
+    {
+        return m_staticObjects[clampDepth(depth)];
+    }
+
+    unsigned int staticVersion() const
+    {
+        return m_staticVersion;
+    }
+
+    inline void add(GraphObject* go);
+    inline void remove(GraphObject* go);
+    inline void makeStatic(GraphObject* go);
+
+  private:
+    std::vector<GraphObject*> m_graphObjects[NUM_DEPTHS];
+    std::vector<GraphObject*> m_staticObjects[NUM_DEPTHS];
+    unsigned int m_staticVersion = 0;
+
+    inline std::vector<GraphObject*>& listOf(GraphObject* go);
+
+    static int clampDepth(int depth)
+    {
+        return (depth >= 0  &&  depth < NUM_DEPTHS) ? depth : 0;
+    }
+};
+
 class GraphObject
 {
   public:
@@ -20,45 +65,52 @@ class GraphObject
     static const int up = 90;
     static const int down = 270;
 
-    GraphObject(int imageID, double startX, double startY, Direction dir = 0, int depth = 0, double size = 1.0)
-     : m_imageID(imageID), m_x(startX), m_y(startY), m_destX(startX), m_destY(startY),
-       m_animationNumber(0), m_direction(dir), m_depth(depth), m_size(size)
+    GraphObject(GraphObjectRegistry& registry, int imageID, double startX, double startY, Direction dir = 0, int depth = 0, double size = 1.0)
+     : m_registry(&registry), m_registrySlot(-1), m_imageID(imageID), m_x(toFixed(startX)), m_y(toFixed(startY)), m_destX(m_x), m_destY(m_y),
+       m_animationNumber(0), m_direction(dir), m_depth(depth), m_size(size), m_visible(true), m_static(false)
     {
         if (m_size <= 0)
             m_size = 1;
 
-        getGraphObjects(m_depth).insert(this);
+        m_registry->add(this);
     }
 
     virtual ~GraphObject()
     {
-        getGraphObjects(m_depth).erase(this);
+        m_registry->remove(this);
     }
 
     double getX() const
     {
           // If already moved but not yet animated, use new location anyway.
-        return m_destX;
+        return fromFixed(m_destX);
     }
 
     double getY() const
     {
           // If already moved but not yet animated, use new location anyway.
-        return m_destY;
+        return fromFixed(m_destY);
     }
 
     virtual void moveTo(double x, double y)
     {
-        m_destX = x;
-        m_destY = y;
+        m_destX = toFixed(x);
+        m_destY = toFixed(y);
         increaseAnimationNumber();
     }
 
+      // Puts the object at x, y with no move to interpolate, so a reused
+      // object appears there this frame instead of sliding in from its old spot.
+    void jumpTo(double x, double y)
+    {
+        m_x = m_destX = toFixed(x);
+        m_y = m_destY = toFixed(y);
+    }
+
     virtual void moveAngle(Direction angle, int units = 1)
     {
-    	const double PI = 4 * atan(1);
-    	double newX = (getX() + units * cos(angle*1.0 / 360 * 2 * PI));
-    	double newY = (getY() + units * sin(angle*1.0 / 360 * 2 * PI));
+    	double newX, newY;
+    	getPositionInThisDirection(angle, units, newX, newY);
 
     	moveTo(newX, newY);
     	increaseAnimationNumber();
@@ -66,9 +118,14 @@ class GraphObject
 
     virtual void getPositionInThisDirection(Direction angle, int units, double &dx, double &dy)
     {
-    	const double PI = 4 * atan(1);
-    	dx = (getX() + units * cos(angle*1.0 / 360 * 2 * PI));
-    	dy = (getY() + units * sin(angle*1.0 / 360 * 2 * PI));
+    	Fixed x = m_destX;
+    	Fixed y = m_destY;
+    	stepFixed(x, y, angle, units);
+#ifdef KONTAGION_CHECK_FIXED_POINT
+    	checkFixedStep(getX(), getY(), angle, units, x, y);
+#endif
+    	dx = fromFixed(x);     // exact, so moveTo stores x and y unchanged
+    	dy = fromFixed(y);
     }
 
     void moveForward(int units = 1)
@@ -99,6 +156,24 @@ class GraphObject
         return m_size;
     }
 
+    void setVisible(bool shouldIDisplay)
+    {
+        m_visible = shouldIDisplay;
+    }
+
+    bool isVisible() const
+    {
+        return m_visible;
+    }
+
+      // For an object that will never again move, turn, resize, animate or
+      // change visibility: it is then drawn from a cached layer, beneath all
+      // the others, that is redrawn only when a static object comes or goes.
+    void makeStatic()
+    {
+        m_registry->makeStatic(this);
+    }
+
       // The following should be used by only the framework, not the student
 
     void increaseAnimationNumber()
@@ -106,15 +181,48 @@ class GraphObject
         m_animationNumber++;
     }
 
+      // Call before each tick: where every object is now becomes where it
+      // was, so drawing can blend from there to where the tick moves it.
+    static void startTick(GraphObjectRegistry& registry)
+    {
+        for (int depth = 0; depth < GraphObjectRegistry::NUM_DEPTHS; depth++)
+        {
+            for (GraphObject* go : registry.objectsAtDepth(depth))
+            {
+                go->m_x = go->m_destX;
+                go->m_y = go->m_destY;
+            }
+        }
+    }
+
+      // Plots each object that is not static alpha of the way (0 to 1) from
+      // where it was before the last tick to where it is now.
+    template<typename Func>
+    static void drawAllObjects(GraphObjectRegistry& registry, Func plotFunc, double alpha = 1)
+    {
+        for (int depth = GraphObjectRegistry::NUM_DEPTHS - 1; depth >= 0; depth--)
+        {
+            for (GraphObject* go : registry.objectsAtDepth(depth))
+            {
+                if (!go->m_visible)
+                    continue;
+                double x = fromFixed(go->m_x) + fromFixed(go->m_destX - go->m_x) * alpha;
+                double y = fromFixed(go->m_y) + fromFixed(go->m_destY - go->m_y) * alpha;
+                plotFunc(go->m_imageID, go->m_animationNumber, x, y, go->m_direction, go->m_size, depth);
+            }
+        }
+    }
+
     template<typename Func>
-    static void drawAllObjects(Func plotFunc)
+    static void drawStaticObjects(GraphObjectRegistry& registry, Func plotFunc)
     {
-        for (int depth = NUM_DEPTHS - 1; depth >= 0; depth--)
+        for (int depth = GraphObjectRegistry::NUM_DEPTHS - 1; depth >= 0; depth--)
         {
-            for (GraphObject* go : getGraphObjects(depth))
+            for (GraphObject* go : registry.staticObjectsAtDepth(depth))
             {
-                go->animate();
-                plotFunc(go->m_imageID, go->m_animationNumber, go->m_x, go->m_y, go->m_direction, go->m_size);
+                if (go->m_visible)
+                    plotFunc(go->m_imageID, go->m_animationNumber, fromFixed(go->m_destX), fromFixed(go->m_destY),
+                             go->m_direction, go->m_size, depth);
             }
         }
     }
@@ -124,45 +232,55 @@ class GraphObject
     GraphObject& operator=(const GraphObject&) = delete;
 
   private:
+    friend class GraphObjectRegistry;
 
-    static const int NUM_DEPTHS = 4;
+    GraphObjectRegistry* m_registry;
+    int     m_registrySlot;
     int     m_imageID;
-    double  m_x;
-    double  m_y;
-    double  m_destX;
-    double  m_destY;
+    Fixed   m_x;        // 16.16, see FixedPoint.h; where it was before this tick
+    Fixed   m_y;
+    Fixed   m_destX;    // where it is now
+    Fixed   m_destY;
     int     m_animationNumber;
     Direction   m_direction;
     int     m_depth;
     double  m_size;
+    bool    m_visible;
+    bool    m_static;
+};
 
-    void animate()
-    {
-        m_x = m_destX;
-        m_y = m_destY;
-        //moveALittle(m_x, m_destX);
-        //moveALittle(m_y, m_destY);
-    }
+inline std::vector<GraphObject*>& GraphObjectRegistry::listOf(GraphObject* go)
+{
+    return (go->m_static ? m_staticObjects : m_graphObjects)[clampDepth(go->m_depth)];
+}
 
-    void moveALittle(double& from, double& to)
-    {
-        static const double DISTANCE = 1.0/ANIMATION_POSITIONS_PER_TICK;
-        if (to - from >= DISTANCE)
-            from += DISTANCE;
-        else if (from - to >= DISTANCE)
-            from -= DISTANCE;
-        else
-            from = to;
-    }
+inline void GraphObjectRegistry::add(GraphObject* go)
+{
+    std::vector<GraphObject*>& objects = listOf(go);
+    go->m_registrySlot = static_cast<int>(objects.size());
+    objects.push_back(go);
+    if (go->m_static)
+        m_staticVersion++;
+}
 
-    static std::set<GraphObject*>& getGraphObjects(int depth)
-    {
-        static std::set<GraphObject*> graphObjects[NUM_DEPTHS];
-        if (depth < NUM_DEPTHS)
-            return graphObjects[depth];
-        else
-            return graphObjects[0];     // empty;
-    }
-};
+inline void GraphObjectRegistry::remove(GraphObject* go)
+{
+    std::vector<GraphObject*>& objects = listOf(go);
+    GraphObject* last = objects.back();
+    objects[go->m_registrySlot] = last;
+    last->m_registrySlot = go->m_registrySlot;
+    objects.pop_back();
+    if (go->m_static)
+        m_staticVersion++;
+}
+
+inline void GraphObjectRegistry::makeStatic(GraphObject* go)
+{
+    if (go->m_static)
+        return;
+    remove(go);
+    go->m_static = true;
+    add(go);
+}
 
 #endif // GRAPHOBJ_H_
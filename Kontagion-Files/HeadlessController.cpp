@@ -0,0 +1,111 @@
+#include "HeadlessController.h"
+#include "GameWorld.h"
+#include "GameConstants.h"
+#include "AudioMixer.h"
+#include <chrono>
+using namespace std;
+
+HeadlessController::HeadlessController()
+ : m_audio(nullptr), m_lastKeyHit(INVALID_KEY), m_quit(false), m_soundsPlayed(0)
+{
+}
+
+HeadlessController::Results HeadlessController::run(GameWorld* gw, long maxTicks)
+{
+    Results results;
+    gw->setController(this);
+    m_quit = false;
+    m_soundsPlayed = 0;
+
+    auto start = chrono::steady_clock::now();
+
+    bool needInit = true;
+    while (!m_quit  &&  results.ticks < maxTicks)
+    {
+        if (needInit)
+        {
+            int status = gw->init();
+            gw->submitSounds();
+            needInit = false;
+            if (status == GWSTATUS_PLAYER_WON)
+            {
+                results.playerWon = true;
+                results.gameOver = true;
+                break;
+            }
+            if (status == GWSTATUS_LEVEL_ERROR)
+            {
+                results.levelError = true;
+                break;
+            }
+        }
+
+        m_lastKeyHit = (m_keySource ? m_keySource(results.ticks) : INVALID_KEY);
+        int status = gw->move();
+        gw->submitSounds();
+        results.ticks++;
+        if (m_tickObserver)
+            m_tickObserver(gw);
+
+        if (status == GWSTATUS_PLAYER_DIED)
+        {
+            results.livesLost++;
+            gw->cleanUp();
+            if (gw->isGameOver())
+            {
+                results.gameOver = true;
+                break;
+            }
+            needInit = true;
+        }
+        else if (status == GWSTATUS_FINISHED_LEVEL)
+        {
+            results.levelsCompleted++;
+            gw->advanceToNextLevel();
+            gw->cleanUp();
+            needInit = true;
+        }
+    }
+    if (!needInit)
+        gw->cleanUp();
+
+    results.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    results.finalLevel = gw->getLevel();
+    results.finalScore = gw->getScore();
+    results.soundsPlayed = m_soundsPlayed;
+    results.soundRequests = gw->soundStats().requests;
+    return results;
+}
+
+bool HeadlessController::getLastKey(int& value)
+{
+    if (m_lastKeyHit != INVALID_KEY)
+    {
+        value = m_lastKeyHit;
+        m_lastKeyHit = INVALID_KEY;
+        return true;
+    }
+    return false;
+}
+
+void HeadlessController::playSound(int soundID)
+{
+    if (soundID != SOUND_NONE)
+        m_soundsPlayed++;
+    if (m_audio == nullptr)
+        return;
+    if (soundID == SOUND_NONE)
+        m_audio->stopAll();
+    else
+        m_audio->play(soundID);
+}
+
+void HeadlessController::setGameStatText(string text)
+{
+    m_gameStatText = text;
+}
+
+void HeadlessController::quitGame()
+{
+    m_quit = true;
+}
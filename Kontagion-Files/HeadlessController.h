@@ -0,0 +1,83 @@
+#ifndef HEADLESSCONTROLLER_H_
+#define HEADLESSCONTROLLER_H_
+
+#include "GameHost.h"
+#include <string>
+#include <functional>
+
+class GameWorld;
+class AudioMixer;
+
+  // Drives a GameWorld through init/move/cleanUp as fast as the CPU allows,
+  // with no window, GLUT or timer.  Keys come from a KeySource that is asked
+  // once per tick (a script, a bot, or nothing), and sounds are counted and,
+  // if an AudioMixer is attached, mixed.
+
+class HeadlessController : public GameHost
+{
+  public:
+      // Returns the key to press before the given tick, or INVALID_KEY for none
+    using KeySource = std::function<int(long tick)>;
+
+      // Called after every move, before the world is cleaned up for a death
+      // or a finished level, so the world's state can be inspected
+    using TickObserver = std::function<void(GameWorld* gw)>;
+
+    struct Results
+    {
+        long   ticks = 0;
+        int    levelsCompleted = 0;
+        int    livesLost = 0;
+        int    finalLevel = 0;
+        int    finalScore = 0;
+        long   soundsPlayed = 0;
+        long   soundRequests = 0;   // before SoundBatch merged and capped them
+        bool   gameOver = false;
+        bool   playerWon = false;
+        bool   levelError = false;
+        double seconds = 0;
+    };
+
+    HeadlessController();
+
+    void setKeySource(KeySource source)
+    {
+        m_keySource = source;
+    }
+
+    void setTickObserver(TickObserver observer)
+    {
+        m_tickObserver = observer;
+    }
+
+      // Sounds also go to this mixer, which must outlive the run
+    void setAudio(AudioMixer* audio)
+    {
+        m_audio = audio;
+    }
+
+      // Plays until the game ends, the player quits or maxTicks moves have run.
+      // The world is cleaned up but not deleted.
+    Results run(GameWorld* gw, long maxTicks);
+
+    virtual bool getLastKey(int& value);
+    virtual void playSound(int soundID);
+    virtual void setGameStatText(std::string text);
+    virtual void quitGame();
+
+    const std::string& gameStatText() const
+    {
+        return m_gameStatText;
+    }
+
+  private:
+    KeySource   m_keySource;
+    TickObserver m_tickObserver;
+    AudioMixer* m_audio;
+    int         m_lastKeyHit;
+    bool        m_quit;
+    long        m_soundsPlayed;
+    std::string m_gameStatText;
+};
+
+#endif // HEADLESSCONTROLLER_H_
@@ -0,0 +1,146 @@
+#include "MappedFile.h"
+#include <utility>
+using namespace std;
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+ : m_data(nullptr), m_size(0), m_open(false)
+#ifdef _MSC_VER
+   , m_mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::MappedFile(const string& fileName)
+ : MappedFile()
+{
+    open(fileName);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+ : MappedFile()
+{
+    *this = move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    if (this != &other)
+    {
+        close();
+        swap(m_data, other.m_data);
+        swap(m_size, other.m_size);
+        swap(m_open, other.m_open);
+#ifdef _MSC_VER
+        swap(m_mapping, other.m_mapping);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _MSC_VER
+
+bool MappedFile::open(const string& fileName)
+{
+    close();
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size > 0)  // an empty file cannot be mapped, but opens fine
+    {
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr)
+            m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    CloseHandle(file);  // the mapping keeps the file open
+    if (m_size > 0  &&  m_data == nullptr)
+    {
+        close();
+        return false;
+    }
+    m_open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#else
+
+bool MappedFile::open(const string& fileName)
+{
+    close();
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(statbuf.st_size);
+    if (m_size > 0)  // an empty file cannot be mapped, but opens fine
+    {
+        void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+            m_data = static_cast<const unsigned char*>(p);
+    }
+    ::close(fd);  // the mapping keeps the file open
+    if (m_size > 0  &&  m_data == nullptr)
+    {
+        m_size = 0;
+        return false;
+    }
+    m_open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
+
+void MappedFile::prefault() const
+{
+    const size_t PAGE = 4096;
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < m_size; i += PAGE)
+        sink = sink + m_data[i];
+}
@@ -0,0 +1,53 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+
+  // A read-only view of a whole file, mapped into memory rather than read
+  // into a buffer.  Pages come in from disk the first time they are touched,
+  // and the view lasts until the MappedFile is closed or destroyed.
+
+class MappedFile
+{
+  public:
+    MappedFile();
+    explicit MappedFile(const std::string& fileName);
+    ~MappedFile();
+
+    bool open(const std::string& fileName);
+    void close();
+
+    bool isOpen() const
+    {
+        return m_open;
+    }
+
+    const unsigned char* data() const
+    {
+        return m_data;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+      // Touches every page so the disk reads happen now rather than on first use
+    void prefault() const;
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+  private:
+    const unsigned char* m_data;
+    std::size_t          m_size;
+    bool                 m_open;
+#ifdef _MSC_VER
+    void*                m_mapping;     // HANDLE of the file mapping object
+#endif
+};
+
+#endif // MAPPEDFILE_H_
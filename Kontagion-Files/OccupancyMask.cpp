@@ -0,0 +1,95 @@
+#include "OccupancyMask.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	// Leave a little slack on both sides of the radius so rounding in the exact
+	// sqrt test can never disagree with a cell we call definitely free or blocked.
+	const double EDGE_EPSILON = 1e-6;
+
+	double squared(double v)
+	{
+		return v * v;
+	}
+
+	// squared distances from a point to the nearest and farthest points of the unit cell at cx, cy
+	void cellDistances(int cx, int cy, double x, double y, double& nearest, double& farthest)
+	{
+		double nearX = std::max(std::max(cx - x, x - (cx + 1)), 0.0);
+		double nearY = std::max(std::max(cy - y, y - (cy + 1)), 0.0);
+		double farX = std::max(std::abs(cx - x), std::abs(cx + 1 - x));
+		double farY = std::max(std::abs(cy - y), std::abs(cy + 1 - y));
+		nearest = squared(nearX) + squared(nearY);
+		farthest = squared(farX) + squared(farY);
+	}
+}
+
+OccupancyMask::OccupancyMask(double blockRadius)
+	: m_blockRadius(blockRadius), m_fullCover(WIDTH * HEIGHT), m_partialCover(WIDTH * HEIGHT), m_ring(WIDTH * HEIGHT)
+{
+	double r2 = squared(VIEW_RADIUS);
+	for (int cy = 0; cy < HEIGHT; cy++)		//classify every cell against the arena circle once
+	{
+		for (int cx = 0; cx < WIDTH; cx++)
+		{
+			double nearest, farthest;
+			cellDistances(cx, cy, VIEW_WIDTH / 2, VIEW_HEIGHT / 2, nearest, farthest);
+			if (farthest < r2 - EDGE_EPSILON)
+				m_ring[cy * WIDTH + cx] = RING_INSIDE;
+			else if (nearest > r2 + EDGE_EPSILON)
+				m_ring[cy * WIDTH + cx] = RING_OUTSIDE;
+			else
+				m_ring[cy * WIDTH + cx] = RING_EDGE;
+		}
+	}
+}
+
+void OccupancyMask::addBlocker(double x, double y)
+{
+	changeBlocker(x, y, 1);
+}
+
+void OccupancyMask::removeBlocker(double x, double y)
+{
+	changeBlocker(x, y, -1);
+}
+
+void OccupancyMask::changeBlocker(double x, double y, int delta)
+{
+	double r2 = squared(m_blockRadius);
+	int minX = std::max(static_cast<int>(std::floor(x - m_blockRadius)) - 1, 0);
+	int maxX = std::min(static_cast<int>(std::floor(x + m_blockRadius)) + 1, WIDTH - 1);
+	int minY = std::max(static_cast<int>(std::floor(y - m_blockRadius)) - 1, 0);
+	int maxY = std::min(static_cast<int>(std::floor(y + m_blockRadius)) + 1, HEIGHT - 1);
+	for (int cy = minY; cy <= maxY; cy++)
+	{
+		for (int cx = minX; cx <= maxX; cx++)
+		{
+			double nearest, farthest;
+			cellDistances(cx, cy, x, y, nearest, farthest);
+			if (farthest < r2 - EDGE_EPSILON)
+				m_fullCover[cy * WIDTH + cx] += delta;
+			else if (nearest <= r2 + EDGE_EPSILON)
+				m_partialCover[cy * WIDTH + cx] += delta;
+		}
+	}
+}
+
+void OccupancyMask::clear()
+{
+	std::fill(m_fullCover.begin(), m_fullCover.end(), 0);
+	std::fill(m_partialCover.begin(), m_partialCover.end(), 0);
+}
+
+OccupancyMask::Result OccupancyMask::lookup(double x, double y) const
+{
+	if (!(x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT))		//off the raster, let the caller decide
+		return UNKNOWN;
+	int cell = static_cast<int>(y) * WIDTH + static_cast<int>(x);
+	if (m_ring[cell] == RING_OUTSIDE || m_fullCover[cell] > 0)
+		return BLOCKED;
+	if (m_ring[cell] == RING_INSIDE && m_partialCover[cell] == 0)
+		return FREE;
+	return UNKNOWN;
+}
@@ -0,0 +1,39 @@
+#ifndef OCCUPANCYMASK_H_
+#define OCCUPANCYMASK_H_
+
+#include "GameConstants.h"
+#include <vector>
+#include <cstdint>
+
+// Rasterized answer to "can a moving actor step onto this point" for the whole
+// arena, one cell per unit of distance. Each cell remembers how many blockers
+// cover it completely and how many only touch part of it, and whether it lies
+// inside, outside or across the VIEW_RADIUS circle. Most cells are then either
+// definitely free or definitely blocked; the few cells on a boundary report
+// UNKNOWN so the caller can fall back to the exact distance test.
+class OccupancyMask
+{
+public:
+	enum Result { FREE, BLOCKED, UNKNOWN };
+
+	OccupancyMask(double blockRadius);
+	void addBlocker(double x, double y);		//a blocker of blockRadius now covers the area around x, y
+	void removeBlocker(double x, double y);		//must be given the same location the blocker was added at
+	void clear();		//remove every blocker, the arena circle is kept
+	Result lookup(double x, double y) const;
+
+private:
+	static const int WIDTH = VIEW_WIDTH;
+	static const int HEIGHT = VIEW_HEIGHT;
+
+	enum RingState : std::uint8_t { RING_INSIDE, RING_OUTSIDE, RING_EDGE };
+
+	double m_blockRadius;
+	std::vector<std::uint16_t> m_fullCover;		//blockers covering every point of the cell
+	std::vector<std::uint16_t> m_partialCover;	//blockers covering only some points of the cell
+	std::vector<RingState> m_ring;
+
+	void changeBlocker(double x, double y, int delta);
+};
+
+#endif // OCCUPANCYMASK_H_
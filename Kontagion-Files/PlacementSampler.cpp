@@ -0,0 +1,28 @@
+#include "PlacementSampler.h"
+#include "GameConstants.h"
+#include "FixedPoint.h"
+
+PlacementSampler::PlacementSampler()
+	: m_candidates(NUM_ANGLES * NUM_RADII), m_live(0)
+{
+	reset();
+}
+
+void PlacementSampler::reset()
+{
+	for (std::size_t i = 0; i < m_candidates.size(); i++)		//restore the original order so a seed always draws the same locations
+		m_candidates[i] = static_cast<std::uint16_t>(i);
+	m_live = static_cast<int>(m_candidates.size());
+}
+
+int PlacementSampler::candidatesLeft() const
+{
+	return m_live;
+}
+
+void PlacementSampler::location(int candidate, double& x, double& y)
+{
+	polarOffset(candidate / NUM_RADII, candidate % NUM_RADII, x, y);
+	x += VIEW_WIDTH / 2;
+	y += VIEW_HEIGHT / 2;
+}
@@ -0,0 +1,57 @@
+#ifndef PLACEMENTSAMPLER_H_
+#define PLACEMENTSAMPLER_H_
+
+#include "Random.h"
+#include <vector>
+#include <cstdint>
+
+// Picks start locations for the objects a level begins with. The candidates
+// are every (angle, radius) pair a random placement can land on, 360 angles by
+// 121 radii, and each draw picks one of the candidates still live with equal
+// chance, so locations are spread exactly as rerolling until one fits would
+// spread them. Objects placed during init are never removed, so a candidate
+// that does not fit will never fit again this level; it is dropped instead of
+// being drawn again. Every candidate is rejected at most once, which bounds
+// the work of a whole level, and running out of candidates is reported
+// instead of looping forever.
+class PlacementSampler
+{
+public:
+	static const int NUM_ANGLES = 360;
+	static const int NUM_RADII = 121;		//radius 0 to 120 from the center of the dish
+
+	PlacementSampler();
+	void reset();		//make every candidate live again, for a new level
+
+	// Draws candidates until isFree(x, y) accepts one and stores it in x, y.
+	// Returns false once every candidate has been rejected.
+	template<typename IsFree>
+	bool sample(RandomStream& random, IsFree isFree, double& x, double& y);
+
+	int candidatesLeft() const;
+
+private:
+	std::vector<std::uint16_t> m_candidates;		//angle * NUM_RADII + radius, live ones first
+	int m_live;
+
+	static void location(int candidate, double& x, double& y);
+};
+
+template<typename IsFree>
+bool PlacementSampler::sample(RandomStream& random, IsFree isFree, double& x, double& y)
+{
+	while (m_live > 0)
+	{
+		int i = random.nextInt(0, m_live - 1);
+		location(m_candidates[i], x, y);
+		if (isFree(x, y))
+			return true;
+		m_live--;		//swap the rejected candidate out of the live range
+		std::uint16_t rejected = m_candidates[i];
+		m_candidates[i] = m_candidates[m_live];
+		m_candidates[m_live] = rejected;
+	}
+	return false;
+}
+
+#endif // PLACEMENTSAMPLER_H_
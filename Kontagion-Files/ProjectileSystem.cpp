@@ -0,0 +1,143 @@
+#include "ProjectileSystem.h"
+#include "GameConstants.h"
+
+namespace
+{
+	struct KindInfo
+	{
+		int imageID;
+		double range;
+		int damage;
+	};
+
+	const KindInfo KINDS[ProjectileSystem::NUM_KINDS] =
+	{
+		{ IID_SPRAY, 112, 2 },
+		{ IID_FLAME, 32, 5 },
+	};
+}
+
+ProjectileSystem::ProjectileSystem(GraphObjectRegistry& registry)
+	: m_registry(&registry)
+{
+	for (int k = 0; k < NUM_KINDS; k++)
+		m_counts[k] = 0;
+}
+
+ProjectileSystem::~ProjectileSystem()
+{
+	for (std::size_t i = 0; i < m_sprites.size(); i++)
+		delete m_sprites[i];
+	for (int k = 0; k < NUM_KINDS; k++)
+	{
+		for (std::size_t i = 0; i < m_spareSprites[k].size(); i++)
+			delete m_spareSprites[k][i];
+	}
+}
+
+void ProjectileSystem::launch(Kind kind, double x, double y, Direction direction)
+{
+	const KindInfo& info = KINDS[kind];
+	const UnitVector& u = unitVector(direction);		//same step GraphObject::moveAngle takes, so flight paths are unchanged
+	m_x.push_back(toFixed(x));
+	m_y.push_back(toFixed(y));
+	m_dx.push_back(scaleUnit(u.x, SPRITE_WIDTH));
+	m_dy.push_back(scaleUnit(u.y, SPRITE_WIDTH));
+	m_traveled.push_back(0);
+	m_range.push_back(info.range);
+	m_damage.push_back(info.damage);
+	m_kind.push_back(static_cast<unsigned char>(kind));
+	m_alive.push_back(1);
+
+	GraphObject* sprite;
+	if (m_spareSprites[kind].empty())
+		sprite = new GraphObject(*m_registry, info.imageID, x, y, direction, 1);
+	else
+	{
+		sprite = m_spareSprites[kind].back();
+		m_spareSprites[kind].pop_back();
+		sprite->jumpTo(x, y);
+		sprite->setDirection(direction);
+		sprite->setVisible(true);
+	}
+	m_sprites.push_back(sprite);
+	m_counts[kind]++;
+}
+
+void ProjectileSystem::advance()
+{
+	int n = size();
+	Fixed* x = m_x.data();
+	Fixed* y = m_y.data();
+	const Fixed* dx = m_dx.data();
+	const Fixed* dy = m_dy.data();
+	double* traveled = m_traveled.data();
+	const double* range = m_range.data();
+	unsigned char* alive = m_alive.data();
+	for (int i = 0; i < n; i++)		//no branches or calls, so the compiler can vectorize this
+	{
+		x[i] += dx[i];
+		y[i] += dy[i];
+		traveled[i] += SPRITE_WIDTH;
+		alive[i] &= static_cast<unsigned char>(traveled[i] < range[i]);
+	}
+}
+
+void ProjectileSystem::compact()
+{
+	int n = size();
+	int live = 0;
+	for (int i = 0; i < n; i++)
+	{
+		if (!m_alive[i])	//hide the sprite and keep it for the next projectile of its kind
+		{
+			m_sprites[i]->setVisible(false);
+			m_spareSprites[m_kind[i]].push_back(m_sprites[i]);
+			m_counts[m_kind[i]]--;
+			continue;
+		}
+		if (live != i)
+		{
+			m_x[live] = m_x[i];
+			m_y[live] = m_y[i];
+			m_dx[live] = m_dx[i];
+			m_dy[live] = m_dy[i];
+			m_traveled[live] = m_traveled[i];
+			m_range[live] = m_range[i];
+			m_damage[live] = m_damage[i];
+			m_kind[live] = m_kind[i];
+			m_alive[live] = m_alive[i];
+			m_sprites[live] = m_sprites[i];
+		}
+		m_sprites[live]->moveTo(fromFixed(m_x[live]), fromFixed(m_y[live]));
+		m_sprites[live]->increaseAnimationNumber();		//projectiles animate twice per move like moveAngle did
+		live++;
+	}
+	m_x.resize(live);
+	m_y.resize(live);
+	m_dx.resize(live);
+	m_dy.resize(live);
+	m_traveled.resize(live);
+	m_range.resize(live);
+	m_damage.resize(live);
+	m_kind.resize(live);
+	m_alive.resize(live);
+	m_sprites.resize(live);
+}
+
+void ProjectileSystem::clear()
+{
+	for (std::size_t i = 0; i < m_alive.size(); i++)
+		m_alive[i] = 0;
+	compact();
+}
+
+int ProjectileSystem::size() const
+{
+	return static_cast<int>(m_x.size());
+}
+
+int ProjectileSystem::count(Kind kind) const
+{
+	return m_counts[kind];
+}
@@ -0,0 +1,87 @@
+#ifndef PROJECTILESYSTEM_H_
+#define PROJECTILESYSTEM_H_
+
+#include "GraphObject.h"
+#include "TaskScheduler.h"
+#include <vector>
+
+class Actor;
+
+// Sprays and flames, kept as flat arrays instead of one heap Actor each. A
+// tick resolves every projectile's hit in one batched pass over the arrays,
+// then advances them all in a single branch-free loop and compacts out the
+// ones that hit something or ran out of range. Sprites are only for drawing:
+// each kind keeps a stash of hidden sprites that new projectiles reuse.
+class ProjectileSystem
+{
+public:
+	enum Kind { SPRAY, FLAME, NUM_KINDS };
+
+	ProjectileSystem(GraphObjectRegistry& registry);
+	~ProjectileSystem();
+
+	void launch(Kind kind, double x, double y, Direction direction);
+	void clear();		//remove every projectile
+	int size() const;
+	int count(Kind kind) const;
+
+	// findTarget(x, y) returns the Actor a projectile at x, y damages, or nullptr.
+	// Every target is found before any damage is dealt, then applyHit(target, damage)
+	// is called for each hit in launch order, then all projectiles move. With a
+	// scheduler the targets are found in parallel, so findTarget must only read.
+	template<typename FindTarget, typename ApplyHit>
+	void update(FindTarget findTarget, ApplyHit applyHit, TaskScheduler* scheduler = nullptr);
+
+	ProjectileSystem(const ProjectileSystem&) = delete;
+	ProjectileSystem& operator=(const ProjectileSystem&) = delete;
+
+private:
+	GraphObjectRegistry* m_registry;
+
+	std::vector<Fixed> m_x;			//current location, 16.16 like GraphObject
+	std::vector<Fixed> m_y;
+	std::vector<Fixed> m_dx;			//movement per tick, SPRITE_WIDTH along the firing direction
+	std::vector<Fixed> m_dy;
+	std::vector<double> m_traveled;
+	std::vector<double> m_range;
+	std::vector<int> m_damage;
+	std::vector<unsigned char> m_kind;
+	std::vector<unsigned char> m_alive;
+	std::vector<GraphObject*> m_sprites;
+	std::vector<Actor*> m_targets;		//scratch for the batched hit pass
+
+	std::vector<GraphObject*> m_spareSprites[NUM_KINDS];
+	int m_counts[NUM_KINDS];
+
+	void advance();		//move every projectile one step and age it
+	void compact();		//drop dead projectiles, keeping launch order, and sync the live sprites
+};
+
+template<typename FindTarget, typename ApplyHit>
+void ProjectileSystem::update(FindTarget findTarget, ApplyHit applyHit, TaskScheduler* scheduler)
+{
+	int n = size();
+	m_targets.resize(n);
+	auto findTargets = [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+			m_targets[i] = findTarget(fromFixed(m_x[i]), fromFixed(m_y[i]));
+	};
+	const int FIND_GRAIN = 16;
+	if (scheduler != nullptr)
+		scheduler->parallelFor(n, FIND_GRAIN, findTargets);
+	else
+		findTargets(0, n);
+	for (int i = 0; i < n; i++)
+	{
+		if (m_targets[i] != nullptr)	//projectiles are used up by dealing damage
+		{
+			applyHit(m_targets[i], m_damage[i]);
+			m_alive[i] = 0;
+		}
+	}
+	advance();
+	compact();
+}
+
+#endif // PROJECTILESYSTEM_H_
@@ -0,0 +1,85 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+// Seedable counter-based random numbers. A stream is just a 64-bit key and a
+// counter, and its n-th value is a hash of the two, so what a stream produces
+// never depends on how other streams were used. Each world owns its streams,
+// every actor gets its own stream split off from whoever spawned it, and the
+// world keeps one stream per purpose (placement, goodies, ...), so a given
+// seed always replays the same game no matter what order actors update in.
+class RandomStream
+{
+public:
+	RandomStream(std::uint64_t key = 0)
+		: m_key(key), m_counter(0)
+	{}
+
+	static RandomStream forPurpose(std::uint64_t seed, std::uint64_t purpose)	//independent stream for one use of a world seed
+	{
+		return RandomStream(finalize(mix(seed) ^ (purpose * SPLIT_GAMMA)));
+	}
+
+	std::uint64_t next()
+	{
+		return mix(m_key + (++m_counter) * GOLDEN_GAMMA);
+	}
+
+	int nextInt(int min, int max)	//uniformly distributed int from min to max, inclusive
+	{
+		if (max < min)
+		{
+			int t = max;
+			max = min;
+			min = t;
+		}
+		return min + scale(next(), static_cast<std::uint32_t>(max - min) + 1);
+	}
+
+	RandomStream split()	//child stream, determined only by this stream's key and position
+	{
+		return RandomStream(finalize(next()));
+	}
+
+	std::uint64_t key() const
+	{
+		return m_key;
+	}
+
+	std::uint64_t position() const
+	{
+		return m_counter;
+	}
+
+private:
+	static const std::uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+	static const std::uint64_t SPLIT_GAMMA = 0xD1B54A32D192ED03ULL;
+
+	std::uint64_t m_key;
+	std::uint64_t m_counter;
+
+	static std::uint64_t mix(std::uint64_t z)	//splitmix64 finalizer
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	static std::uint64_t finalize(std::uint64_t z)	//murmur3 finalizer, keeps child keys uncorrelated with parent outputs
+	{
+		z = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCDULL;
+		z = (z ^ (z >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+		return z ^ (z >> 33);
+	}
+
+	static int scale(std::uint64_t value, std::uint32_t range)	//multiply-shift into [0, range), range of 0 means all 2^32 values
+	{
+		std::uint64_t high = value >> 32;
+		if (range == 0)
+			return static_cast<int>(static_cast<std::uint32_t>(high));
+		return static_cast<int>((high * range) >> 32);
+	}
+};
+
+#endif // RANDOM_H_
@@ -0,0 +1,57 @@
+#include "SoundBatch.h"
+#include "GameHost.h"
+#include "GameConstants.h"
+#include <algorithm>
+using namespace std;
+
+SoundBatch::SoundBatch()
+ : m_numPending(0), m_stop(false)
+{
+    fill(m_priority, m_priority + MAX_SOUND_IDS, 0);
+    fill(m_requests, m_requests + MAX_SOUND_IDS, 0);
+    for (const SoundInfo& s : SOUND_INFO)
+    {
+        if (s.soundID < MAX_SOUND_IDS)
+            m_priority[s.soundID] = s.priority;
+    }
+}
+
+void SoundBatch::add(int soundID)
+{
+    m_stats.requests++;
+    if (soundID == SOUND_NONE)
+    {
+        clear();
+        m_stop = true;
+        return;
+    }
+    if (soundID < 0  ||  soundID >= MAX_SOUND_IDS)
+        return;
+    if (m_requests[soundID]++ == 0)
+        m_pending[m_numPending++] = soundID;
+}
+
+void SoundBatch::submit(GameHost& host)
+{
+    if (m_stop)
+        host.playSound(SOUND_NONE);
+
+      // At most MAX_SOUND_IDS entries, so a stable sort keeps equal
+      // priorities in the order the tick asked for them
+    stable_sort(m_pending, m_pending + m_numPending,
+                [this](int a, int b) { return m_priority[a] > m_priority[b]; });
+    int n = min(m_numPending, MAX_SOUNDS_PER_TICK);
+    for (int i = 0; i < n; i++)
+        host.playSound(m_pending[i]);
+    m_stats.submitted += n;
+
+    clear();
+    m_stop = false;
+}
+
+void SoundBatch::clear()
+{
+    for (int i = 0; i < m_numPending; i++)
+        m_requests[m_pending[i]] = 0;
+    m_numPending = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef SOUNDBATCH_H_
+#define SOUNDBATCH_H_
+
+class GameHost;
+
+  // Collects the sounds a world asks for during one tick and hands them to
+  // its host together once the tick is over.  Asking for a sound is a counter
+  // bump however often it happens: a sound asked for many times starts once,
+  // and only the MAX_SOUNDS_PER_TICK highest priority sounds (see SOUND_INFO)
+  // start at all, so a tick full of dying bacteria costs the host no more than
+  // a quiet one.  SOUND_NONE drops whatever the tick asked for before it and
+  // stops what is already playing.
+
+class SoundBatch
+{
+  public:
+    static constexpr int MAX_SOUND_IDS = 32;   // IDs at or above this are ignored
+
+    struct Stats
+    {
+        long requests = 0;      // playSound calls
+        long submitted = 0;     // sounds the host was asked to play
+    };
+
+    SoundBatch();
+
+    void add(int soundID);
+
+      // Plays the tick's sounds on host, highest priority first, and starts
+      // the next tick empty.
+    void submit(GameHost& host);
+
+    const Stats& stats() const
+    {
+        return m_stats;
+    }
+
+  private:
+    int   m_priority[MAX_SOUND_IDS];
+    int   m_requests[MAX_SOUND_IDS];   // this tick, by ID
+    int   m_pending[MAX_SOUND_IDS];    // IDs asked for this tick, in first-asked order
+    int   m_numPending;
+    bool  m_stop;
+    Stats m_stats;
+
+    void clear();
+};
+
+#endif // SOUNDBATCH_H_
@@ -0,0 +1,82 @@
+#include "SpatialGrid.h"
+#include <cmath>
+#include <algorithm>
+
+SpatialGrid::SpatialGrid()
+	: m_cells(CELLS_X * CELLS_Y)
+{}
+
+int SpatialGrid::cellCoord(double v, int numCells)
+{
+	int c = static_cast<int>(std::floor(v / CELL_SIZE));
+	if (c < 0)		//clamp anything past the edge of the arena into the border cells
+		return 0;
+	if (c >= numCells)
+		return numCells - 1;
+	return c;
+}
+
+int SpatialGrid::cellIndex(double x, double y)
+{
+	return cellCoord(y, CELLS_Y) * CELLS_X + cellCoord(x, CELLS_X);
+}
+
+int SpatialGrid::find(const Cell& cell, const Actor* a)
+{
+	for (int i = 0; i < cell.size(); i++)
+	{
+		if (cell.actors[i] == a)
+			return i;
+	}
+	return -1;
+}
+
+void SpatialGrid::insert(Actor* a, double x, double y)
+{
+	Cell& cell = m_cells[cellIndex(x, y)];
+	cell.xs.push_back(x);
+	cell.ys.push_back(y);
+	cell.actors.push_back(a);
+}
+
+void SpatialGrid::remove(Actor* a, double x, double y)
+{
+	Cell& cell = m_cells[cellIndex(x, y)];
+	int i = find(cell, a);
+	if (i >= 0)	//order within a cell does not matter, so swap the last actor into the hole
+	{
+		cell.xs[i] = cell.xs.back();
+		cell.ys[i] = cell.ys.back();
+		cell.actors[i] = cell.actors.back();
+		cell.xs.pop_back();
+		cell.ys.pop_back();
+		cell.actors.pop_back();
+	}
+}
+
+void SpatialGrid::move(Actor* a, double oldX, double oldY, double newX, double newY)
+{
+	Cell& cell = m_cells[cellIndex(oldX, oldY)];
+	if (&cell == &m_cells[cellIndex(newX, newY)])		//most moves stay inside the same cell
+	{
+		int i = find(cell, a);
+		if (i >= 0)
+		{
+			cell.xs[i] = newX;
+			cell.ys[i] = newY;
+		}
+		return;
+	}
+	remove(a, oldX, oldY);
+	insert(a, newX, newY);
+}
+
+void SpatialGrid::clear()
+{
+	for (std::size_t i = 0; i < m_cells.size(); i++)
+	{
+		m_cells[i].xs.clear();
+		m_cells[i].ys.clear();
+		m_cells[i].actors.clear();
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef SPATIALGRID_H_
+#define SPATIALGRID_H_
+
+#include "GameConstants.h"
+#include <vector>
+
+class Actor;
+
+// Uniform grid of SPRITE_WIDTH buckets over the arena, used by StudentWorld so
+// proximity queries only visit actors in nearby cells. Positions outside the
+// arena are clamped into the edge cells, so every actor is always in a bucket.
+// Each cell stores its actors' locations in parallel x and y arrays, so the
+// queries can run the DistanceKernels over a cell without touching the actors.
+class SpatialGrid
+{
+public:
+	struct Cell
+	{
+		std::vector<double> xs;
+		std::vector<double> ys;
+		std::vector<Actor*> actors;
+
+		int size() const
+		{
+			return static_cast<int>(actors.size());
+		}
+	};
+
+	SpatialGrid();
+	void insert(Actor* a, double x, double y);		//add an actor at a location
+	void remove(Actor* a, double x, double y);		//remove an actor, x and y must be the location it was last inserted or moved to
+	void move(Actor* a, double oldX, double oldY, double newX, double newY);	//record an actor's new location
+	void clear();
+
+	template<typename Func>
+	bool forEachCellNear(double x, double y, double radius, Func f) const;	//call f on every cell within radius, stops and returns true once f returns true
+
+private:
+	static const int CELL_SIZE = SPRITE_WIDTH;
+	static const int CELLS_X = VIEW_WIDTH / CELL_SIZE;
+	static const int CELLS_Y = VIEW_HEIGHT / CELL_SIZE;
+
+	std::vector<Cell> m_cells;
+
+	static int cellCoord(double v, int numCells);
+	static int cellIndex(double x, double y);
+	static int find(const Cell& cell, const Actor* a);
+};
+
+template<typename Func>
+bool SpatialGrid::forEachCellNear(double x, double y, double radius, Func f) const
+{
+	int minX = cellCoord(x - radius, CELLS_X);
+	int maxX = cellCoord(x + radius, CELLS_X);
+	int minY = cellCoord(y - radius, CELLS_Y);
+	int maxY = cellCoord(y + radius, CELLS_Y);
+	for (int cy = minY; cy <= maxY; cy++)
+	{
+		for (int cx = minX; cx <= maxX; cx++)
+		{
+			const Cell& cell = m_cells[cy * CELLS_X + cx];
+			if (cell.size() > 0 && f(cell))
+				return true;
+		}
+	}
+	return false;
+}
+
+#endif // SPATIALGRID_H_
@@ -0,0 +1,337 @@
+#include "SpriteAtlas.h"
+#include "GameConstants.h"
+#include "MappedFile.h"
+#include "TaskScheduler.h"
+#include "AssetPack.h"
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+using namespace std;
+
+static double millisecondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static int powerOfTwoAtLeast(int n)
+{
+    int p = 1;
+    while (p < n)
+        p *= 2;
+    return p;
+}
+
+  // Decodes an uncompressed 24- or 32-bit TGA into BGRA; 24-bit images are
+  // opaque.  Rows stay in file order.
+static bool decodeTga(const unsigned char* data, size_t size, int& width, int& height, vector<unsigned char>& bgra)
+{
+    const size_t HEADER_SIZE = 18;
+    if (size < HEADER_SIZE)
+        return false;
+
+      //image type either 2 (color) or 3 (greyscale)
+    if (data[1] != 0 || (data[2] != 2 && data[2] != 3))
+        return false;
+    int byteCount = data[16] / 8;
+    if (byteCount != 3 && byteCount != 4)
+        return false;
+
+    width = data[12] + data[13] * 256;
+    height = data[14] + data[15] * 256;
+    size_t pixels = static_cast<size_t>(width) * height;
+    size_t start = HEADER_SIZE + data[0];  // pixels follow the image ID field
+    if (width == 0  ||  height == 0  ||  size < start + pixels * byteCount)
+        return false;
+
+    const unsigned char* in = data + start;
+    bgra.resize(pixels * 4);
+    for (size_t p = 0; p < pixels; p++)
+    {
+        bgra[4*p]     = in[byteCount*p];
+        bgra[4*p + 1] = in[byteCount*p + 1];
+        bgra[4*p + 2] = in[byteCount*p + 2];
+        bgra[4*p + 3] = (byteCount == 4 ? in[4*p + 3] : 255);
+    }
+    return true;
+}
+
+bool SpriteAtlas::load(const string& assetPath, TaskScheduler& scheduler, LoadTimes& times, string& error)
+{
+    const int count = sizeof(SPRITE_INFO) / sizeof(SPRITE_INFO[0]);
+    vector<MappedFile> files(count);
+    vector<Image> images(count);
+    vector<char> ok(count, 0);  // char, not bool, so threads write separate bytes
+
+    auto start = chrono::steady_clock::now();
+    scheduler.parallelFor(count, 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            ok[i] = files[i].open(assetPath + SPRITE_INFO[i].tgaFileName);
+            if (ok[i])
+                files[i].prefault();
+        }
+    });
+    times.io = millisecondsSince(start);
+    for (int i = 0; i < count; i++)
+    {
+        if (!ok[i])
+        {
+            error = "Cannot open " + assetPath + SPRITE_INFO[i].tgaFileName;
+            return false;
+        }
+    }
+
+    start = chrono::steady_clock::now();
+    scheduler.parallelFor(count, 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            Image& image = images[i];
+            image.imageID = SPRITE_INFO[i].imageID;
+            image.frame = SPRITE_INFO[i].frameNum;
+            ok[i] = decodeTga(files[i].data(), files[i].size(), image.width, image.height, image.bgra);
+            files[i].close();
+        }
+    });
+    times.decode = millisecondsSince(start);
+    for (int i = 0; i < count; i++)
+    {
+        if (!ok[i])
+        {
+            error = "Cannot decode " + assetPath + SPRITE_INFO[i].tgaFileName;
+            return false;
+        }
+    }
+
+    start = chrono::steady_clock::now();
+    pack(images, scheduler);
+    times.pack = millisecondsSince(start);
+
+    start = chrono::steady_clock::now();
+    buildMipmaps(scheduler);
+    times.mipmaps = millisecondsSince(start);
+    return true;
+}
+
+  // How a saved atlas appears in a pack: one record per frame, in image
+  // order, under FRAMES_ENTRY, and each mip level under LEVEL_ENTRY and its
+  // number, as a LevelHeader followed by the pixels.
+static const char* const FRAMES_ENTRY = "atlas.frames";
+static const char* const LEVEL_ENTRY = "atlas.level";
+
+struct FrameRecord
+{
+    int32_t imageID;
+    float   u0, v0, u1, v1;
+};
+
+struct LevelHeader
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved[2];   // keeps the pixels 16-byte aligned
+};
+
+bool SpriteAtlas::load(const AssetPack& pack, LoadTimes& times, string& error)
+{
+    auto start = chrono::steady_clock::now();
+    const unsigned char* data;
+    size_t size;
+    if (!pack.find(FRAMES_ENTRY, data, size)  ||  size == 0  ||  size % sizeof(FrameRecord) != 0)
+    {
+        error = string("Asset pack has no ") + FRAMES_ENTRY;
+        return false;
+    }
+    vector<FrameRecord> records(size / sizeof(FrameRecord));
+    memcpy(records.data(), data, size);
+    vector<int> imageIDs;
+    m_rects.clear();
+    for (const FrameRecord& r : records)
+    {
+        if (r.imageID < 0  ||  (!imageIDs.empty()  &&  r.imageID < imageIDs.back()))
+        {
+            error = string("Asset pack has a bad ") + FRAMES_ENTRY;
+            return false;
+        }
+        imageIDs.push_back(r.imageID);
+        m_rects.push_back(Rect{ r.u0, r.v0, r.u1, r.v1 });
+    }
+    setFrames(imageIDs);
+
+    m_pixels.clear();
+    m_levels.clear();
+    for (int level = 0; level < MIP_LEVELS  &&  pack.find(LEVEL_ENTRY + to_string(level), data, size); level++)
+    {
+        LevelHeader header;
+        if (size < sizeof(header))
+            break;
+        memcpy(&header, data, sizeof(header));
+        if (header.width == 0  ||  header.height == 0  ||
+            (size - sizeof(header)) / 4 / header.width < header.height)
+            break;
+        m_levels.push_back(Level{ int(header.width), int(header.height), data + sizeof(header) });
+    }
+    if (m_levels.empty())
+    {
+        error = string("Asset pack has no ") + LEVEL_ENTRY + "0";
+        return false;
+    }
+    times = LoadTimes();
+    times.io = millisecondsSince(start);
+    return true;
+}
+
+void SpriteAtlas::save(AssetPackWriter& writer) const
+{
+    vector<FrameRecord> records;
+    for (int imageID = 0; imageID < static_cast<int>(m_frameCount.size()); imageID++)
+    {
+        for (int f = 0; f < m_frameCount[imageID]; f++)
+        {
+            const Rect& r = m_rects[m_firstFrame[imageID] + f];
+            records.push_back(FrameRecord{ imageID, r.u0, r.v0, r.u1, r.v1 });
+        }
+    }
+    writer.add(FRAMES_ENTRY, records.data(), records.size() * sizeof(FrameRecord));
+
+    for (size_t level = 0; level < m_levels.size(); level++)
+    {
+        const Level& l = m_levels[level];
+        LevelHeader header = { uint32_t(l.width), uint32_t(l.height), { 0, 0 } };
+        vector<unsigned char> blob(sizeof(header) + size_t(l.width) * l.height * 4);
+        memcpy(blob.data(), &header, sizeof(header));
+        memcpy(blob.data() + sizeof(header), l.bgra, blob.size() - sizeof(header));
+        writer.add(LEVEL_ENTRY + to_string(level), blob.data(), blob.size());
+    }
+}
+
+void SpriteAtlas::releasePixels()
+{
+    vector<Level>().swap(m_levels);
+    vector<vector<unsigned char>>().swap(m_pixels);
+}
+
+  // Builds the by-image tables from each rectangle's image ID, which must
+  // come in ascending order
+void SpriteAtlas::setFrames(vector<int> imageIDs)
+{
+    int maxImageID = imageIDs.back();
+    m_firstFrame.assign(maxImageID + 1, 0);
+    m_frameCount.assign(maxImageID + 1, 0);
+    for (int i = static_cast<int>(imageIDs.size()) - 1; i >= 0; i--)
+    {
+        m_firstFrame[imageIDs[i]] = i;
+        m_frameCount[imageIDs[i]]++;
+    }
+}
+
+void SpriteAtlas::pack(vector<Image>& images, TaskScheduler& scheduler)
+{
+      // Frames of one image sit next to each other in the rectangle table
+    sort(images.begin(), images.end(), [](const Image& a, const Image& b) {
+        return a.imageID != b.imageID ? a.imageID < b.imageID : a.frame < b.frame;
+    });
+    vector<int> imageIDs;
+    for (const Image& image : images)
+        imageIDs.push_back(image.imageID);
+    setFrames(imageIDs);
+
+      // Shelf packing, tallest first
+    vector<int> order(images.size());
+    long area = 0;
+    int widest = 0;
+    for (int i = 0; i < static_cast<int>(order.size()); i++)
+    {
+        order[i] = i;
+        area += long(images[i].width + 2*PADDING) * (images[i].height + 2*PADDING);
+        widest = max(widest, images[i].width + 2*PADDING);
+    }
+    sort(order.begin(), order.end(), [&images](int a, int b) {
+        return images[a].height > images[b].height;
+    });
+    int atlasWidth = powerOfTwoAtLeast(max(widest, static_cast<int>(sqrt(double(area)))));
+    vector<int> left(images.size());
+    vector<int> top(images.size());
+    int x = 0;
+    int shelfTop = 0;
+    int shelfHeight = 0;
+    for (int i : order)
+    {
+        int w = images[i].width + 2*PADDING;
+        int h = images[i].height + 2*PADDING;
+        if (x + w > atlasWidth)
+        {
+            shelfTop += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        left[i] = x;
+        top[i] = shelfTop;
+        x += w;
+        shelfHeight = max(shelfHeight, h);
+    }
+    int atlasHeight = powerOfTwoAtLeast(shelfTop + shelfHeight);
+
+    m_pixels.assign(1, vector<unsigned char>(size_t(atlasWidth) * atlasHeight * 4, 0));
+    m_levels.assign(1, Level{ atlasWidth, atlasHeight, m_pixels[0].data() });
+    m_rects.resize(images.size());
+    unsigned char* atlas = m_pixels[0].data();
+
+      // Frames don't overlap, so each can be copied in on any thread
+    scheduler.parallelFor(static_cast<int>(images.size()), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            const Image& image = images[i];
+            for (int ay = 0; ay < image.height + 2*PADDING; ay++)
+            {
+                int sy = min(max(ay - PADDING, 0), image.height - 1);
+                for (int ax = 0; ax < image.width + 2*PADDING; ax++)
+                {
+                    int sx = min(max(ax - PADDING, 0), image.width - 1);
+                    const unsigned char* from = &image.bgra[4 * (size_t(sy) * image.width + sx)];
+                    copy(from, from + 4, atlas + 4 * ((size_t(top[i]) + ay) * atlasWidth + left[i] + ax));
+                }
+            }
+            Rect& r = m_rects[i];
+            r.u0 = float(left[i] + PADDING) / atlasWidth;
+            r.v0 = float(top[i] + PADDING) / atlasHeight;
+            r.u1 = float(left[i] + PADDING + image.width) / atlasWidth;
+            r.v1 = float(top[i] + PADDING + image.height) / atlasHeight;
+        }
+    });
+}
+
+void SpriteAtlas::buildMipmaps(TaskScheduler& scheduler)
+{
+    while (m_levels.size() < MIP_LEVELS  &&  (m_levels.back().width > 1  ||  m_levels.back().height > 1))
+    {
+        const Level from = m_levels.back();
+        Level to = { max(from.width / 2, 1), max(from.height / 2, 1), nullptr };
+        m_pixels.push_back(vector<unsigned char>(size_t(to.width) * to.height * 4));
+        unsigned char* out = m_pixels.back().data();
+        to.bgra = out;
+
+          // Each texel is the mean of the 2x2 block above it; rows are independent
+        scheduler.parallelFor(to.height, 16, [&](int begin, int end) {
+            for (int y = begin; y < end; y++)
+            {
+                int y0 = min(2*y, from.height - 1);
+                int y1 = min(2*y + 1, from.height - 1);
+                for (int x = 0; x < to.width; x++)
+                {
+                    int x0 = min(2*x, from.width - 1);
+                    int x1 = min(2*x + 1, from.width - 1);
+                    for (int c = 0; c < 4; c++)
+                    {
+                        int sum = from.bgra[4 * (size_t(y0) * from.width + x0) + c]
+                                + from.bgra[4 * (size_t(y0) * from.width + x1) + c]
+                                + from.bgra[4 * (size_t(y1) * from.width + x0) + c]
+                                + from.bgra[4 * (size_t(y1) * from.width + x1) + c];
+                        out[4 * (size_t(y) * to.width + x) + c] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+        });
+        m_levels.push_back(to);
+    }
+}
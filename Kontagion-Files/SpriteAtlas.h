@@ -0,0 +1,104 @@
+#ifndef SPRITEATLAS_H_
+#define SPRITEATLAS_H_
+
+#include <string>
+#include <vector>
+
+class TaskScheduler;
+class AssetPack;
+class AssetPackWriter;
+
+  // Every sprite frame in SPRITE_INFO, decoded and packed into one BGRA image
+  // with its mipmaps, ready for SpriteManager to hand to OpenGL.  Nothing here
+  // touches OpenGL, so the files are mapped, decoded and filtered on worker
+  // threads and only the upload is left for the thread that owns the context.
+  //
+  // Each frame gets a border of copies of its edge pixels so filtering and
+  // the smaller mipmaps don't bleed its neighbors into it; the mip chain
+  // stops where a texel would span the whole border.  A frame's place in the
+  // atlas is found by indexing flat arrays by image ID and frame.
+  //
+  // A finished atlas can be saved into an AssetPack and loaded back from one
+  // with no decoding or filtering at all; its pixels then stay in the pack.
+
+class SpriteAtlas
+{
+  public:
+    static constexpr int PADDING = 4;
+    static constexpr int MIP_LEVELS = 3;    // level 0 and two halvings
+
+    struct Rect
+    {
+        float u0, v0, u1, v1;
+    };
+
+    struct Level
+    {
+        int width;
+        int height;
+        const unsigned char* bgra;  // into the atlas's own storage or a pack
+    };
+
+      // Wall-clock milliseconds spent in each stage of load
+    struct LoadTimes
+    {
+        double io = 0;          // mapping the files and paging them in
+        double decode = 0;      // TGA to BGRA
+        double pack = 0;        // placing and copying frames into the atlas
+        double mipmaps = 0;
+        double upload = 0;      // handing the levels to OpenGL, timed by SpriteManager
+    };
+
+      // Loads every frame in SPRITE_INFO from assetPath and builds the atlas,
+      // spreading each stage over scheduler's threads.  On failure error
+      // says which file was at fault.
+    bool load(const std::string& assetPath, TaskScheduler& scheduler, LoadTimes& times, std::string& error);
+
+      // Loads an atlas saved by save.  The pack must stay open until the
+      // pixels are released.
+    bool load(const AssetPack& pack, LoadTimes& times, std::string& error);
+
+    void save(AssetPackWriter& writer) const;
+
+    int numFrames(int imageID) const
+    {
+        return imageID >= 0 && imageID < static_cast<int>(m_frameCount.size()) ? m_frameCount[imageID] : 0;
+    }
+
+      // frame wraps around the image's frame count, which must not be 0
+    const Rect& frameRect(int imageID, int frame) const
+    {
+        return m_rects[m_firstFrame[imageID] + frame % m_frameCount[imageID]];
+    }
+
+    const std::vector<Level>& levels() const
+    {
+        return m_levels;
+    }
+
+      // Frees the pixels once they have been uploaded; the rectangles remain
+    void releasePixels();
+
+  private:
+    struct Image
+    {
+        int imageID;
+        int frame;
+        int width;
+        int height;
+        std::vector<unsigned char> bgra;
+    };
+
+    std::vector<Rect>   m_rects;        // every frame of every image, in image order
+    std::vector<int>    m_firstFrame;   // by imageID, index of frame 0 in m_rects
+    std::vector<int>    m_frameCount;   // by imageID
+    std::vector<Level>  m_levels;
+    std::vector<std::vector<unsigned char>> m_pixels;  // by level, unless loaded from a pack
+
+    void setFrames(std::vector<int> imageIDs);
+
+    void pack(std::vector<Image>& images, TaskScheduler& scheduler);
+    void buildMipmaps(TaskScheduler& scheduler);
+};
+
+#endif // SPRITEATLAS_H_
@@ -0,0 +1,144 @@
+#ifndef SPRITEBATCH_H_
+#define SPRITEBATCH_H_
+
+#include "freeglut.h"
+#include "FixedPoint.h"
+#include <vector>
+#include <algorithm>
+
+  // Gathers a frame's sprites and draws them all at once.  Each sprite
+  // becomes a rotated quad written straight into client-side vertex arrays;
+  // the quads are sorted farthest depth first and then by texture, so one
+  // glDrawArrays covers every neighboring sprite that shares a texture and
+  // the GL state is set up once per frame rather than once per sprite.
+  // Sprites are drawn without depth testing, as they always were, so the
+  // order within a depth only changes which of two overlapping sprites is on
+  // top.
+
+class SpriteBatch
+{
+public:
+    struct Stats
+    {
+        int sprites = 0;
+        int drawCalls = 0;
+        int vertices = 0;
+    };
+
+      // (gx, gy, gz) is the sprite's center in GL coordinates and
+      // halfWidth/halfHeight its extent before rotation.  An angle of 180
+      // mirrors the sprite instead of turning it upside down.  (u0, v0) and
+      // (u1, v1) are the corners of the sprite's part of the texture.
+    void add(GLuint texture, int depth, float gx, float gy, float gz,
+             int angleDegrees, float halfWidth, float halfHeight,
+             float u0 = 0, float v0 = 0, float u1 = 1, float v1 = 1)
+    {
+        m_sprites.push_back(Sprite{ texture, depth, gx, gy, gz, angleDegrees, halfWidth, halfHeight,
+                                    u0, v0, u1, v1 });
+    }
+
+      // Draws everything added since the last draw, then empties the batch.
+    void draw()
+    {
+        m_lastFrame = Stats();
+        if (m_sprites.empty())
+            return;
+
+        std::stable_sort(m_sprites.begin(), m_sprites.end(),
+            [](const Sprite& a, const Sprite& b)
+            {
+                if (a.depth != b.depth)
+                    return a.depth > b.depth;
+                return a.texture < b.texture;
+            });
+
+        m_positions.clear();
+        m_texCoords.clear();
+        for (const Sprite& s : m_sprites)
+            appendQuad(s);
+
+        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glEnable(GL_TEXTURE_2D);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glColor3f(1.0, 1.0, 1.0);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 0, m_positions.data());
+        glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords.data());
+
+          // Depth groups are already in drawing order, so a run of one
+          // texture may carry on from one depth into the next
+        int count = static_cast<int>(m_sprites.size());
+        for (int first = 0; first < count; )
+        {
+            int last = first + 1;
+            while (last < count  &&  m_sprites[last].texture == m_sprites[first].texture)
+                last++;
+            glBindTexture(GL_TEXTURE_2D, m_sprites[first].texture);
+            glDrawArrays(GL_QUADS, first * 4, (last - first) * 4);
+            m_lastFrame.drawCalls++;
+            first = last;
+        }
+
+        glPopClientAttrib();
+        glPopAttrib();
+
+        m_lastFrame.sprites = count;
+        m_lastFrame.vertices = count * 4;
+        m_sprites.clear();
+    }
+
+      // What the last draw did
+    const Stats& lastFrame() const
+    {
+        return m_lastFrame;
+    }
+
+private:
+    struct Sprite
+    {
+        GLuint  texture;
+        int     depth;
+        float   gx, gy, gz;
+        int     angle;
+        float   halfWidth, halfHeight;
+        float   u0, v0, u1, v1;
+    };
+
+    std::vector<Sprite>  m_sprites;
+    std::vector<GLfloat> m_positions;   // x, y, z per vertex
+    std::vector<GLfloat> m_texCoords;   // u, v per vertex
+    Stats                m_lastFrame;
+
+    void appendQuad(const Sprite& s)
+    {
+        static const float CORNERS[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+        static const float UNIT = static_cast<float>(1 << UNIT_FRACTION_BITS);
+
+        float c = 1;
+        float sn = 0;
+        float mirror = -1;
+        if (s.angle != 180)
+        {
+            const UnitVector& u = unitVector(s.angle);
+            c = u.x / UNIT;
+            sn = u.y / UNIT;
+            mirror = 1;
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            float x = CORNERS[k][0] * s.halfWidth;
+            float y = CORNERS[k][1] * s.halfHeight;
+            m_positions.push_back(s.gx + mirror * (x * c - y * sn));
+            m_positions.push_back(s.gy + y * c + x * sn);
+            m_positions.push_back(s.gz);
+            m_texCoords.push_back(CORNERS[k][0] > 0 ? s.u1 : s.u0);
+            m_texCoords.push_back(CORNERS[k][1] > 0 ? s.v1 : s.v0);
+        }
+    }
+};
+
+#endif // SPRITEBATCH_H_
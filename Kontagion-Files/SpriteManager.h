@@ -11,12 +11,23 @@
 #define GL_BGRA GL_BGRA_EXT
 #endif
 
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
 #include "GameConstants.h"
+#include "SpriteBatch.h"
+#include "SpriteAtlas.h"
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <map>
+#include <vector>
 #include <memory>
+#include <chrono>
 #include <cmath>
 
 static const double VISIBLE_MIN_X = -2.39;
@@ -26,181 +37,106 @@ static const double VISIBLE_MAX_Y = 1.9;
 static const double VISIBLE_MIN_Z = -20;
 // static const double VISIBLE_MAX_Z = -6;
 
+  // Draws sprites from one texture atlas (see SpriteAtlas), so a frame's
+  // drawing needs one bound texture and a frame's place in the atlas is found
+  // by indexing flat arrays.  Call loadSprites once before drawing.
+
 class SpriteManager
 {
 public:
 
     SpriteManager()
-     : m_mipMapped(true)
+     : m_mipMapped(true), m_atlasTexture(0), m_staticList(0), m_staticVersion(0), m_ringList(0)
     {
     }
 
-    bool loadSprite(std::string filename_tga, int imageID, int frameNum)
+      // Builds the atlas from the files in assetPath on scheduler's threads,
+      // then uploads it on this one, which must own the GL context.
+    bool loadSprites(const std::string& assetPath, TaskScheduler& scheduler,
+                     SpriteAtlas::LoadTimes& times, std::string& error)
     {
-          // Load Texture Data From TGA File
-
-        int spriteID = getSpriteID(imageID, frameNum);
-        if (spriteID == INVALID_SPRITE_ID)
-            return false;
-
-        m_frameCountPerSprite[imageID]++;   // keep track of how many frames per sprite we loaded
-
-        std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
-        if (!tgaFile)
-            return false;
-
-        char type[3];
-        char info[6];
-
-          // Read file header info
-        tgaFile.read(type, 3);
-        tgaFile.seekg(12);
-        tgaFile.read(info, 6);
-        unsigned int textureWidth = static_cast<unsigned char>(info[0]) + static_cast<unsigned char>(info[1]) * 256;
-        unsigned int textureHeight = static_cast<unsigned char>(info[2]) + static_cast<unsigned char>(info[3]) * 256;
-        unsigned char byteCount = static_cast<unsigned char>(info[4]) / 8;
-        long imageSize = textureWidth * textureHeight * byteCount;
-        std::unique_ptr<char[]> imageData(new char[imageSize]);
-        tgaFile.seekg(18);
-          // Read image data
-        tgaFile.read(imageData.get(), imageSize);
-        if (!tgaFile)
-            return false;
-
-          //image type either 2 (color) or 3 (greyscale)
-        if (type[1] != 0 || (type[2] != 2 && type[2] != 3))
+        if (!m_atlas.load(assetPath, scheduler, times, error))
             return false;
+        uploadAtlas(times);
+        return true;
+    }
 
-        if (byteCount != 3 && byteCount != 4)
+      // Uploads an atlas saved in an asset pack, which needs no decoding;
+      // the pack must stay open until this returns.
+    bool loadSprites(const AssetPack& pack, SpriteAtlas::LoadTimes& times, std::string& error)
+    {
+        if (!m_atlas.load(pack, times, error))
             return false;
-
-          // Transfer Texture To OpenGL
-
-        glEnable(GL_DEPTH_TEST);
-
-          // allocate a texture handle
-        GLuint glTextureID;
-        glGenTextures(1, &glTextureID);
-
-          // bind our new texture
-        glBindTexture(GL_TEXTURE_2D, glTextureID);
-
-        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-
-        if (m_mipMapped)
-        {
-              // when texture area is small, bilinear filter the closest mipmap
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-              // when texture area is large, bilinear filter the first mipmap
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        }
-        else
-        {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        }
-
-          // Have the texture wrap both vertically and horizontally.
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
-
-        if (m_mipMapped)
-        {
-              // build our texture mipmaps
-              // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-            makeMipmaps(byteCount, textureWidth, textureHeight, imageData.get());
-        }
-        else
-        {
-              // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-            if (3 == byteCount)
-                glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData.get());
-            else if (4 == byteCount)
-                glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData.get());
-        }
-
-        m_imageMap[spriteID] = glTextureID;
-
+        uploadAtlas(times);
         return true;
     }
 
     int getNumFrames(int imageID) const
     {
-        auto it = m_frameCountPerSprite.find(imageID);
-        if (it == m_frameCountPerSprite.end())
-            return 0;
-
-        return it->second;
+        return m_atlas.numFrames(imageID);
     }
 
-    bool plotSprite(int imageID, int frame, double x, double y, int angleDegrees, double size)
+      // Adds a sprite to this frame's batch; drawQueuedSprites draws them.
+      // Sprites at a greater depth end up beneath those at a smaller one, and
+      // frame wraps around the number of frames the image has.
+    bool queueSprite(int imageID, int frame, int depth, double x, double y, int angleDegrees, double size)
     {
-        int spriteID = getSpriteID(imageID, frame);
-        if (spriteID == INVALID_SPRITE_ID)
-            return false;
-
-        auto it = m_imageMap.find(spriteID);
-        if (it == m_imageMap.end())
-            return false;
-
-        glPushMatrix();
+        return addSprite(m_batch, imageID, frame, depth, x, y, angleDegrees, size);
+    }
 
-        double finalWidth = SPRITE_WIDTH_GL * size;
-        double finalHeight = SPRITE_HEIGHT_GL * size;
+    void drawQueuedSprites()
+    {
+        m_batch.draw();
+    }
 
-        // object's x/y location is center-based, but sprite plotting is upper-left-corner based
-        const double xoffset = 0;// finalWidth / 2;
-        const double yoffset = 0;// finalHeight / 2;
+    const SpriteBatch::Stats& lastFrameStats() const
+    {
+        return m_batch.lastFrame();
+    }
 
-        double gx, gy, gz;
-        convertToGlutCoords(x, y, gx, gy, gz);
-        glTranslatef(static_cast<GLfloat>(gx-xoffset),static_cast<GLfloat>(gy-yoffset),static_cast<GLfloat>(gz));
-        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_TEXTURE_2D);
-        glDisable(GL_DEPTH_TEST);
-        glEnable (GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glBindTexture(GL_TEXTURE_2D, it->second);
-
-        glColor3f(1.0, 1.0, 1.0);
-
-        double cx1 = 0, cy1 = 0;
-        double cx2 = 1, cy2 = 0;
-        double cx3 = 1, cy3 = 1;
-        double cx4 = 0, cy4 = 1;
-
-          // Rotate sprite.  For 180 degrees, don't rotate, but reflect
-        double rx1, ry1, rx2, ry2, rx3, ry3, rx4, ry4;
-        double rotationAngle = (angleDegrees == 180 ? 0 : angleDegrees);
-        rotate(-finalWidth / 2, -finalHeight / 2, rotationAngle, rx1, ry1);
-        rotate( finalWidth / 2, -finalHeight / 2, rotationAngle, rx2, ry2);
-        rotate( finalWidth / 2,  finalHeight / 2, rotationAngle, rx3, ry3);
-        rotate(-finalWidth / 2,  finalHeight / 2, rotationAngle, rx4, ry4);
-        if (angleDegrees == 180)
+      // Draws the layer of sprites that never move from a display list,
+      // recording it again only when version differs from the one it was
+      // recorded at.  To record it, queueAll is called and must hand every
+      // sprite in the layer to queueStaticSprite.
+    template<typename Func>
+    void drawStaticLayer(unsigned int version, Func queueAll)
+    {
+        if (m_staticList == 0  ||  version != m_staticVersion)
         {
-            // No rotation happened, but reflect to face left
-            std::swap(rx1, rx2);
-            std::swap(rx3, rx4);
+            if (m_staticList == 0)
+                m_staticList = glGenLists(1);
+            queueAll();
+            glNewList(m_staticList, GL_COMPILE);   // the arrays' contents are copied into the list
+            m_staticBatch.draw();
+            glEndList();
+            m_staticVersion = version;
         }
+        glCallList(m_staticList);
+    }
 
-        glBegin(GL_QUADS);
-        glTexCoord2d(cx1, cy1);
-        glVertex3f(static_cast<GLfloat>(rx1), static_cast<GLfloat>(ry1), 0);
-        glTexCoord2d(cx2, cy2);
-        glVertex3f(static_cast<GLfloat>(rx2), static_cast<GLfloat>(ry2), 0);
-        glTexCoord2d(cx3, cy3);
-        glVertex3f(static_cast<GLfloat>(rx3), static_cast<GLfloat>(ry3), 0);
-        glTexCoord2d(cx4, cy4);
-        glVertex3f(static_cast<GLfloat>(rx4), static_cast<GLfloat>(ry4), 0);
-        glEnd();
-
-        glDisable(GL_TEXTURE_2D);
-        glEnable(GL_DEPTH_TEST);
+    bool queueStaticSprite(int imageID, int frame, int depth, double x, double y, int angleDegrees, double size)
+    {
+        return addSprite(m_staticBatch, imageID, frame, depth, x, y, angleDegrees, size);
+    }
 
-        glPopAttrib();
-        glPopMatrix();
+      // What the static layer held when it was last recorded
+    const SpriteBatch::Stats& staticLayerStats() const
+    {
+        return m_staticBatch.lastFrame();
+    }
 
-        return true;
+      // drawCircle recorded into a display list the first time, as the ring
+      // around the dish never changes
+    void drawRing(float cx, float cy, float r, int num_segments)
+    {
+        if (m_ringList == 0)
+        {
+            m_ringList = glGenLists(1);
+            glNewList(m_ringList, GL_COMPILE);
+            drawCircle(cx, cy, r, num_segments);
+            glEndList();
+        }
+        glCallList(m_ringList);
     }
 
     static void drawCircle(float cx, float cy, float r, int num_segments) {
@@ -219,34 +155,83 @@ public:
 
     ~SpriteManager()
     {
-        for (auto it = m_imageMap.begin(); it != m_imageMap.end(); it++)
-            glDeleteTextures(1, &it->second);
+        if (m_atlasTexture != 0)
+            glDeleteTextures(1, &m_atlasTexture);
+        if (m_staticList != 0)
+            glDeleteLists(m_staticList, 1);
+        if (m_ringList != 0)
+            glDeleteLists(m_ringList, 1);
     }
 
 private:
 
-    std::map<int, GLuint>   m_imageMap;
-    std::map<int, int>      m_frameCountPerSprite;
+    SpriteAtlas             m_atlas;
     bool                    m_mipMapped;
-
-    static const int INVALID_SPRITE_ID = -1;
-    static const int MAX_IMAGES = 1000;
-    static const int MAX_FRAMES_PER_SPRITE = 100;
-
-    static int getSpriteID(int imageID, int frame)
+    GLuint                  m_atlasTexture;
+    SpriteBatch             m_batch;
+    SpriteBatch             m_staticBatch;
+    GLuint                  m_staticList;
+    unsigned int            m_staticVersion;
+    GLuint                  m_ringList;
+
+    bool addSprite(SpriteBatch& batch, int imageID, int frame, int depth, double x, double y, int angleDegrees, double size)
     {
-        if (imageID >= MAX_IMAGES || frame >= MAX_FRAMES_PER_SPRITE)
-            return INVALID_SPRITE_ID;
+        if (getNumFrames(imageID) == 0 || frame < 0)
+            return false;
+        const SpriteAtlas::Rect& r = m_atlas.frameRect(imageID, frame);
 
-        return imageID * MAX_FRAMES_PER_SPRITE + frame;
+        double gx, gy, gz;
+        convertToGlutCoords(x, y, gx, gy, gz);
+        batch.add(m_atlasTexture, depth, static_cast<float>(gx), static_cast<float>(gy), static_cast<float>(gz),
+                  angleDegrees, static_cast<float>(SPRITE_WIDTH_GL * size / 2), static_cast<float>(SPRITE_HEIGHT_GL * size / 2),
+                  r.u0, r.v0, r.u1, r.v1);
+        return true;
     }
 
-    static void rotate(double x, double y, double degrees, double &xout, double &yout)
+      // Runs on the thread that owns the GL context
+    void uploadAtlas(SpriteAtlas::LoadTimes& times)
     {
-        static const double PI = 4 * atan(1.0);
-        double theta = degrees * (2 * PI / 360);
-        xout = x * cos(theta) - y * sin(theta);
-        yout = y * cos(theta) + x * sin(theta);
+        auto start = std::chrono::steady_clock::now();
+
+          // Transfer Texture To OpenGL
+
+        glEnable(GL_DEPTH_TEST);
+
+          // allocate a texture handle
+        glGenTextures(1, &m_atlasTexture);
+
+          // bind our new texture
+        glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+
+        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+        const std::vector<SpriteAtlas::Level>& levels = m_atlas.levels();
+        int numLevels = (m_mipMapped ? static_cast<int>(levels.size()) : 1);
+        if (m_mipMapped)
+        {
+              // when texture area is small, bilinear filter the closest mipmap
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+              // when texture area is large, bilinear filter the first mipmap
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+        }
+        else
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_CLAMP_TO_EDGE));
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_CLAMP_TO_EDGE));
+
+          // the mipmaps were already filtered by SpriteAtlas
+        for (int level = 0; level < numLevels; level++)
+            glTexImage2D(GL_TEXTURE_2D, level, 4, levels[level].width, levels[level].height, 0,
+                         GL_BGRA, GL_UNSIGNED_BYTE, levels[level].bgra);
+        glFinish();  // so the time below includes the driver's copy
+        m_atlas.releasePixels();
+
+        times.upload = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
 
     static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz)
@@ -257,18 +242,6 @@ private:
         gy = 2 * VISIBLE_MIN_Y +      y * 2 * (VISIBLE_MAX_Y - VISIBLE_MIN_Y);
         gz = .6 * VISIBLE_MIN_Z;
     }
-
-    static void makeMipmaps(unsigned char byteCount, unsigned int textureWidth, unsigned int textureHeight, char* imageData)
-    {
-        int format = (byteCount == 3 ? GL_BGR : GL_BGRA);
-#ifdef __APPLE__
-        int internalFormat = (byteCount == 3 ? GL_RGB : GL_RGBA);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, textureWidth, textureHeight, 0, format, GL_UNSIGNED_BYTE, imageData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-#else
-        gluBuild2DMipmaps(GL_TEXTURE_2D, byteCount, textureWidth, textureHeight, format, GL_UNSIGNED_BYTE, imageData);
-#endif
-    }
 };
 
 #endif // SPRITEMANAGER_H_
@@ -0,0 +1,21 @@
+#include "StatLine.h"
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+StatLine::StatLine()
+ : m_valid(false)
+{
+    m_text[0] = '\0';
+}
+
+bool StatLine::update(const GameStats& stats)
+{
+    if (m_valid  &&  memcmp(&stats, &m_stats, sizeof(stats)) == 0)
+        return false;
+    m_stats = stats;
+    m_valid = true;
+    snprintf(m_text, sizeof(m_text), "Score:  %06d  Level: %d  Lives: %d  Health: %d  Sprays: %d  Flames: %d",
+             stats.score, stats.level, stats.lives, stats.health, stats.sprayCharges, stats.flameCharges);
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef STATLINE_H_
+#define STATLINE_H_
+
+  // What the line of stats at the top of the screen shows.
+
+struct GameStats
+{
+    int score;
+    int level;
+    int lives;
+    int health;
+    int sprayCharges;
+    int flameCharges;
+};
+
+  // Keeps the stats line's text, rebuilding it only when a stat has changed
+  // since the last update.  The text lives in a fixed buffer, so a tick on
+  // which nothing changed costs six comparisons and allocates nothing.
+
+class StatLine
+{
+  public:
+    StatLine();
+
+      // True if stats differed from the last ones and the text was rebuilt
+    bool update(const GameStats& stats);
+
+    const char* text() const
+    {
+        return m_text;
+    }
+
+  private:
+    GameStats m_stats;
+    bool      m_valid;      // false until the first update
+    char      m_text[128];
+};
+
+#endif // STATLINE_H_
@@ -1,16 +1,16 @@
 #include "StudentWorld.h"
 #include "GameConstants.h"
+#include "FixedPoint.h"
 #include "Actor.h"
+#include "DistanceKernels.h"
 #include <string>
 #include <cmath>
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
 using namespace std;
 
-GameWorld* createStudentWorld(string assetPath)
+GameWorld* createStudentWorld(string assetPath, uint64_t seed)
 {
-	return new StudentWorld(assetPath);
+	return new StudentWorld(assetPath, seed);
 }
 
 // Students:  Add code to this file, StudentWorld.h, Actor.h and Actor.cpp
@@ -20,83 +20,78 @@ StudentWorld::~StudentWorld()
 	cleanUp();
 }
 
-StudentWorld::StudentWorld(string assetPath)
-: GameWorld(assetPath)
+namespace
 {
+	enum RandomPurpose { RANDOM_SPAWN, RANDOM_PLACEMENT, RANDOM_GOODIE };
 }
 
-void pickRandLoc(double& x, double& y)
+StudentWorld::StudentWorld(string assetPath, uint64_t seed)
+: GameWorld(assetPath), m_seed(seed),
+  m_spawnRandom(RandomStream::forPurpose(seed, RANDOM_SPAWN)),
+  m_placementRandom(RandomStream::forPurpose(seed, RANDOM_PLACEMENT)),
+  m_goodieRandom(RandomStream::forPurpose(seed, RANDOM_GOODIE)),
+  m_projectiles(graphObjects()), m_dirtMask(SPRITE_WIDTH / 2)
 {
-	double angle = randInt(0, 359) * (PI / 180);
-	double radius = randInt(0, 120);
-	x = radius * cos(angle) + (VIEW_WIDTH / 2);
-	y = radius * sin(angle) + (VIEW_HEIGHT / 2);
+	m_spawnParent = &m_spawnRandom;
 }
 
 int StudentWorld::init()
 {
 	m_Soc = new Socrates(this);		//place socrates in level
+	m_placement.reset();
 
 	double startX;
 	double startY;
 	for (int i = 0; i < getLevel(); i++)
 	{
-		findStartLoc(startX, startY);
-		m_gameObjects.push_back(new Pit(this, startX, startY));
+		if (!findStartLoc(startX, startY))	//the dish is too full to place everything
+			return GWSTATUS_LEVEL_ERROR;
+		addActor(new Pit(this, startX, startY));
 	}
 	for (int i = 0; i < min(5 * getLevel(), 25); i++)	//generate food objects first as they cannot overlap
 	{
-		findStartLoc(startX, startY);
-		m_gameObjects.push_back(new Food(this, startX, startY));
+		if (!findStartLoc(startX, startY))
+			return GWSTATUS_LEVEL_ERROR;
+		addActor(new Food(this, startX, startY));
 		
 	}
 	for (int i = 0; i < max(180 - 20 * getLevel(), 20); i++)	//generate dirt piles according to level
 	{
-		findStartLoc(startX, startY);
-		m_gameObjects.push_back(new DirtPile(this, startX, startY));
+		if (!findStartLoc(startX, startY))
+			return GWSTATUS_LEVEL_ERROR;
+		addActor(new DirtPile(this, startX, startY));
 	}
 	
     return GWSTATUS_CONTINUE_GAME;
 }
 
-void goodieStartLoc(double& x, double& y)	//generate Location of new goodie
+void goodieStartLoc(RandomStream& random, double& x, double& y)	//generate Location of new goodie
 {
-	double  angle = randInt(0, 359) * (PI / 180);
-	x = VIEW_RADIUS * cos(angle) + VIEW_WIDTH / 2;
-	y = VIEW_RADIUS * sin(angle) + VIEW_HEIGHT / 2;
+	int angle = random.nextInt(0, 359);
+	polarOffset(angle, VIEW_RADIUS, x, y);
+	x += VIEW_WIDTH / 2;
+	y += VIEW_HEIGHT / 2;
 }
 
 int StudentWorld::move()
 {
-	for (int i = 0; i < m_gameObjects.size(); i++)	
+	TaskScheduler* scheduler = taskScheduler();
+	bool socratesAlive = (scheduler != nullptr ? updateActorsInTwoPhases(*scheduler) : updateActorsInOrder());
+	if (!socratesAlive)		//return if action causes socrates to die
 	{
-		if (m_gameObjects[i]->isAlive())   //ask each object to dosomething if alive
-			m_gameObjects[i]->doSomething();
-		if (m_Soc->isAlive() == false)		//return if action causes socrates to die
-		{
-			delete m_Soc;
-			m_Soc = nullptr;
-			decLives();
-			return GWSTATUS_PLAYER_DIED;
-		}
-	}
-	for (int i = 0; i < m_gameObjects.size(); i++)
-	{
-		if (m_gameObjects[i]->isAlive() == false)		//remove any dead objects
-		{
-			delete m_gameObjects[i];
-			m_gameObjects.erase(m_gameObjects.begin() + i);
-			i--;
-		}
+		delete m_Soc;
+		m_Soc = nullptr;
+		decLives();
+		return GWSTATUS_PLAYER_DIED;
 	}
+	m_projectiles.update(		//every spray and flame moves in one batch after the other actors
+		[this](double x, double y) { return findDamageable(x, y); },
+		[](Actor* target, int damage) { target->takeDamage(damage); },
+		scheduler);
 
-	bool levelCompleted = true;
+	removeDeadActors();
 
-	for (int i = 0; i < m_gameObjects.size(); i++)	//check if level still has pits or bacteria
-	{
-		if (m_gameObjects[i]->preventsLevelCompleting())
-			levelCompleted = false;
-	}
+	bool levelCompleted = (m_pitsRemaining == 0 && m_bacteriaRemaining == 0);	//check if level still has pits or bacteria
 
 	if (levelCompleted)		//if none, finish level
 	{
@@ -104,122 +99,385 @@ int StudentWorld::move()
 		return GWSTATUS_FINISHED_LEVEL;
 	}
 
+	m_spawnParent = &m_Soc->random();
 	m_Soc->doSomething();		//ask socrates to do something
+	m_spawnParent = &m_spawnRandom;
 
 	double X, Y;	//goodie creation coordinates
 
 	double chanceFungus = max(510 - getLevel() * 10, 200);	//determine whether or not to add a new fungus or goodie
-	int makeFungus = randInt(0, chanceFungus);
+	int makeFungus = m_goodieRandom.nextInt(0, chanceFungus);
 	if (makeFungus == 0)
 	{
-		goodieStartLoc(X, Y);
-		m_gameObjects.push_back(new Fungus(this, X, Y));
+		goodieStartLoc(m_goodieRandom, X, Y);
+		addActor(new Fungus(this, X, Y));
 	}
 
 
 	double chanceGoodie = max(510 - getLevel() * 10, 250);
-	int makeGoodie = randInt(0, chanceGoodie);
+	int makeGoodie = m_goodieRandom.nextInt(0, chanceGoodie);
 	if (makeGoodie == 0)
 	{
-		goodieStartLoc(X, Y);
-		int goodieType = randInt(0, 9);
+		goodieStartLoc(m_goodieRandom, X, Y);
+		int goodieType = m_goodieRandom.nextInt(0, 9);
 		if (goodieType <= 5)
-			m_gameObjects.push_back(new HealthGoodie(this, X, Y));
+			addActor(new HealthGoodie(this, X, Y));
 		else if (goodieType <= 8)
-			m_gameObjects.push_back(new FlameThrowerGoodie(this, X, Y));
+			addActor(new FlameThrowerGoodie(this, X, Y));
 		else
-			m_gameObjects.push_back(new ExtraLifeGoodie(this, X, Y));
+			addActor(new ExtraLifeGoodie(this, X, Y));
 
 	}
 
-	ostringstream oss;		//update stats text line
-	oss << "Score:  ";
-	
-	oss.fill('0');
-	oss << setw(6) << getScore() << endl;
-	oss << "  Level: " << getLevel();
-	oss << "  Lives: " << getLives();
-	oss << "  Health: " << m_Soc->health();
-	oss << "  Sprays: " << m_Soc->sprayCharges();
-	oss << "  Flames: " << m_Soc->flameCharges() << "       ";
-
-	string stats = oss.str();
-	setGameStatText(stats);
+	GameStats stats = { getScore(), getLevel(), getLives(), m_Soc->health(), m_Soc->sprayCharges(), m_Soc->flameCharges() };
+	setGameStats(stats);		//the text is only rebuilt when one of these changed
 
 
     return GWSTATUS_CONTINUE_GAME;
 }
 
+bool StudentWorld::updateActorsInOrder()
+{
+	for (int i = 0; i < m_gameObjects.size(); i++)	
+	{
+		if (m_gameObjects[i]->isAlive())   //ask each object to dosomething if alive, anything it spawns splits from its stream
+		{
+			m_spawnParent = &m_gameObjects[i]->random();
+			m_gameObjects[i]->doSomething();
+			m_spawnParent = &m_spawnRandom;
+		}
+		if (m_Soc->isAlive() == false)
+			return false;
+	}
+	return true;
+}
+
+bool StudentWorld::updateActorsInTwoPhases(TaskScheduler& scheduler)
+{
+	const int PLAN_GRAIN = 32;		//actors per chunk, dirt and food plan nothing so chunks are cheap
+	int planned = static_cast<int>(m_gameObjects.size());
+	scheduler.parallelFor(planned, PLAN_GRAIN, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)	//nothing moves, spawns or dies during planning, so every actor sees the tick's starting state
+		{
+			if (m_gameObjects[i]->isAlive())
+				m_gameObjects[i]->planTick();
+		}
+	});
+	for (int i = 0; i < m_gameObjects.size(); i++)		//then apply the plans in world order, so any thread count gives the same game
+	{
+		if (m_gameObjects[i]->isAlive())
+		{
+			m_spawnParent = &m_gameObjects[i]->random();
+			if (i < planned)
+				m_gameObjects[i]->commitTick();
+			else
+				m_gameObjects[i]->doSomething();	//spawned during this loop so it made no plan, it acts in full like it would in order
+			m_spawnParent = &m_spawnRandom;
+		}
+		if (m_Soc->isAlive() == false)
+			return false;
+	}
+	return true;
+}
+
+void StudentWorld::removeDeadActors()
+{
+	m_actorsReclaimed = removeDead(m_gameObjects);
+	if (m_inertDied)	//most ticks destroy no dirt and eat no food, so the inert list is left alone
+	{
+		m_actorsReclaimed += removeDead(m_inertObjects);
+		m_inertDied = false;
+	}
+}
+
+int StudentWorld::removeDead(vector<Actor*>& actors)
+{
+	vector<Actor*>::iterator firstDead = stable_partition(actors.begin(), actors.end(),
+		[](Actor* a) { return a->isAlive(); });		//compact living objects to the front in one pass, keeping their order
+	for (vector<Actor*>::iterator it = firstDead; it != actors.end(); it++)	//then free the dead ones together
+	{
+		unindexActor(*it);
+		delete *it;
+	}
+	int removed = static_cast<int>(actors.end() - firstDead);
+	actors.erase(firstDead, actors.end());
+	return removed;
+}
+
+RandomStream StudentWorld::spawnStream()
+{
+	return m_spawnParent->split();
+}
+
+RandomStream* StudentWorld::setSpawnParent(RandomStream* parent)
+{
+	RandomStream* previous = m_spawnParent;
+	m_spawnParent = parent;
+	return previous;
+}
+
+uint64_t StudentWorld::seed() const
+{
+	return m_seed;
+}
+
+int StudentWorld::actorsReclaimedLastTick() const
+{
+	return m_actorsReclaimed;
+}
+
 void StudentWorld::cleanUp()
 {
 	for (int i = 0; i < m_gameObjects.size(); i++)	//delete all game objects
 	{
 		delete m_gameObjects[i];
 	}
+	for (Actor* a : m_inertObjects)
+		delete a;
 	if (m_Soc != nullptr)
 		delete m_Soc;	//delete socrates
+	m_Soc = nullptr;
 	m_gameObjects.clear();
+	m_inertObjects.clear();
+	m_inertDied = false;
+	m_projectiles.clear();
+	m_solidGrid.clear();
+	m_damageableGrid.clear();
+	m_edibleGrid.clear();
+	m_blockingGrid.clear();
+	m_dirtMask.clear();
+	fill(begin(m_actorCounts), end(m_actorCounts), 0);
+	m_pitsRemaining = 0;
+	m_bacteriaRemaining = 0;
 }
 
 bool StudentWorld::checkForOverLap(double x, double y, double distance)
 {
-	for (int i = 0; i < m_gameObjects.size(); i++)	//check gameobjects for if the chosen location overlaps with an existing object
-	{
-		if (m_gameObjects[i]->doesOverLap(x, y, distance) && m_gameObjects[i]->canOverLap() == false)
-			return true;
-	}
-	return false;
+	return firstInRadius(m_solidGrid, x, y, distance) != nullptr;	//check nearby objects that cannot be overlapped for if the chosen location overlaps with one
 }
 
-void StudentWorld::findStartLoc(double& startX, double& startY)		//picks random start location until one that does not overlap is found (if overlap not allowed)
+Actor* StudentWorld::firstInRadius(const SpatialGrid& grid, double x, double y, double radius, bool aliveOnly) const
 {
-	do
+	Actor* found = nullptr;
+	grid.forEachCellNear(x, y, radius, [&](const SpatialGrid::Cell& cell)
 	{
-		pickRandLoc(startX, startY);
-	} while (checkForOverLap(startX, startY, SPRITE_WIDTH));
+		for (int start = 0; start < cell.size(); )	//resume the scan past any dead object that is skipped
+		{
+			int i = firstWithinRadius(cell.xs.data() + start, cell.ys.data() + start, cell.size() - start, x, y, radius * radius);
+			if (i < 0)
+				return false;
+			if (!aliveOnly || cell.actors[start + i]->isAlive())
+			{
+				found = cell.actors[start + i];
+				return true;
+			}
+			start += i + 1;
+		}
+		return false;
+	});
+	return found;
 }
 
-bool StudentWorld::damageObject(double xLoc, double yLoc, double damage)	//damages objects with projectiles if projectile overlaps
-{
-	for (int i = 0; i < m_gameObjects.size(); i++)
+bool StudentWorld::findStartLoc(double& startX, double& startY)		//picks random start locations until one that does not overlap is found (if overlap not allowed)
+{
+	return m_placement.sample(m_placementRandom, [this](double x, double y)
 	{
-		if (m_gameObjects[i]->doesOverLap(xLoc, yLoc, SPRITE_WIDTH) && m_gameObjects[i]->isDamageable())	//check if overlaps with object that can be damaged
+		return !checkForOverLap(x, y, SPRITE_WIDTH);
+	}, startX, startY);
+}
+
+Actor* StudentWorld::earliestInRadius(const SpatialGrid& grid, double x, double y, double radius, bool aliveOnly) const
+{
+	Actor* found = nullptr;
+	grid.forEachCellNear(x, y, radius, [&](const SpatialGrid::Cell& cell)
+	{
+		for (int start = 0; start < cell.size(); )	//every match in the cell, keeping the one added to the world first
 		{
-			m_gameObjects[i]->takeDamage(damage);
-			return true;
+			int i = firstWithinRadius(cell.xs.data() + start, cell.ys.data() + start, cell.size() - start, x, y, radius * radius);
+			if (i < 0)
+				break;
+			Actor* a = cell.actors[start + i];
+			if ((!aliveOnly || a->isAlive()) && (found == nullptr || a->worldOrder() < found->worldOrder()))
+				found = a;
+			start += i + 1;
 		}
-	}
-	return false;
+		return false;	//a later cell may still hold an earlier actor
+	});
+	return found;
+}
+
+bool StudentWorld::damageObject(double xLoc, double yLoc, double damage)	//damages objects with projectiles if projectile overlaps
+{
+	Actor* target = findDamageable(xLoc, yLoc);
+	if (target == nullptr)
+		return false;
+	target->takeDamage(damage);		//damage outside the grid walk, dying can spawn new actors
+	return true;
+}
+
+Actor* StudentWorld::findDamageable(double x, double y) const
+{
+	return earliestInRadius(m_damageableGrid, x, y, SPRITE_WIDTH);	//the first damageable object in world order that overlaps, as when the world was searched in order
+}
+
+void StudentWorld::launchProjectile(ProjectileSystem::Kind kind, double x, double y, int direction)
+{
+	m_projectiles.launch(kind, x, y, direction);
 }
 
 void StudentWorld::addActor(Actor* a)
 {
-	m_gameObjects.push_back(a);
+	a->setWorldOrder(m_nextWorldOrder++);	//both lists stay in this order, the sweep keeps survivors in place
+	if (a->actsEachTick())
+		m_gameObjects.push_back(a);
+	else
+		m_inertObjects.push_back(a);
+	indexActor(a);
 }
 
-Actor* StudentWorld::getOverlappingEdible(Actor* a)	
+void StudentWorld::actorDied(const Actor* a)
 {
-	for (int i = 0; i < m_gameObjects.size(); i++)
+	if (!a->actsEachTick())
+		m_inertDied = true;
+}
+
+int StudentWorld::indexesOf(const Actor* a) const	//capabilities never change over an actor's life, so these are only asked for on spawn, move and death
+{
+	int indexes = 0;
+	if (a->canOverLap() == false)
+		indexes |= INDEX_SOLID;
+	if (a->isDamageable())
+		indexes |= INDEX_DAMAGEABLE;
+	if (a->isEdible())
+		indexes |= INDEX_EDIBLE;
+	if (a->blocksMovement())
+		indexes |= INDEX_BLOCKING;
+	if (a->preventsLevelCompleting())
+		indexes |= INDEX_LEVEL_BLOCKING;
+	return indexes;
+}
+
+void StudentWorld::indexActor(Actor* a)
+{
+	int indexes = indexesOf(a);
+	if (indexes & INDEX_SOLID)
+		m_solidGrid.insert(a, a->getX(), a->getY());
+	if (indexes & INDEX_DAMAGEABLE)
+		m_damageableGrid.insert(a, a->getX(), a->getY());
+	if (indexes & INDEX_EDIBLE)
+		m_edibleGrid.insert(a, a->getX(), a->getY());
+	if (indexes & INDEX_BLOCKING)
+	{
+		m_blockingGrid.insert(a, a->getX(), a->getY());
+		m_dirtMask.addBlocker(a->getX(), a->getY());
+	}
+	countActor(a, indexes, 1);
+}
+
+void StudentWorld::unindexActor(Actor* a)
+{
+	int indexes = indexesOf(a);
+	if (indexes & INDEX_SOLID)
+		m_solidGrid.remove(a, a->getX(), a->getY());
+	if (indexes & INDEX_DAMAGEABLE)
+		m_damageableGrid.remove(a, a->getX(), a->getY());
+	if (indexes & INDEX_EDIBLE)
+		m_edibleGrid.remove(a, a->getX(), a->getY());
+	if (indexes & INDEX_BLOCKING)
+	{
+		m_blockingGrid.remove(a, a->getX(), a->getY());
+		m_dirtMask.removeBlocker(a->getX(), a->getY());
+	}
+	countActor(a, indexes, -1);
+}
+
+void StudentWorld::countActor(const Actor* a, int indexes, int delta)
+{
+	ActorType type = a->type();
+	m_actorCounts[type] += delta;
+	if (indexes & INDEX_LEVEL_BLOCKING)
+	{
+		if (type == ACTOR_PIT)
+			m_pitsRemaining += delta;
+		else
+			m_bacteriaRemaining += delta;
+	}
+}
+
+int StudentWorld::actorCount(ActorType type) const
+{
+	if (type == ACTOR_SOCRATES)		//socrates is never in m_gameObjects
+		return m_Soc != nullptr ? 1 : 0;
+	if (type == ACTOR_SPRAY)		//nor are projectiles
+		return m_projectiles.count(ProjectileSystem::SPRAY);
+	if (type == ACTOR_FLAME)
+		return m_projectiles.count(ProjectileSystem::FLAME);
+	return m_actorCounts[type];
+}
+
+int StudentWorld::pitsRemaining() const
+{
+	return m_pitsRemaining;
+}
+
+int StudentWorld::bacteriaRemaining() const
+{
+	return m_bacteriaRemaining;
+}
+
+bool StudentWorld::countsMatchRecount() const
+{
+	int counts[NUM_ACTOR_TYPES] = {};
+	int pits = 0;
+	int bacteria = 0;
+	vector<const Actor*> all(m_gameObjects.begin(), m_gameObjects.end());
+	all.insert(all.end(), m_inertObjects.begin(), m_inertObjects.end());
+	for (const Actor* a : all)
 	{
-		if (m_gameObjects[i]->doesOverLap(a->getX(), a->getY(), SPRITE_WIDTH) && m_gameObjects[i]->isEdible())
-			return m_gameObjects[i];
+		counts[a->type()]++;
+		if (a->preventsLevelCompleting())
+		{
+			if (a->type() == ACTOR_PIT)
+				pits++;
+			else
+				bacteria++;
+		}
 	}
-	return nullptr;
+	return equal(begin(counts), end(counts), begin(m_actorCounts)) && pits == m_pitsRemaining && bacteria == m_bacteriaRemaining;
+}
+
+void StudentWorld::actorMoved(Actor* a, double oldX, double oldY)
+{
+	if (a == m_Soc)		//socrates is kept separately and is not indexed
+		return;
+	int indexes = indexesOf(a);
+	if (indexes & INDEX_SOLID)
+		m_solidGrid.move(a, oldX, oldY, a->getX(), a->getY());
+	if (indexes & INDEX_DAMAGEABLE)
+		m_damageableGrid.move(a, oldX, oldY, a->getX(), a->getY());
+	if (indexes & INDEX_EDIBLE)
+		m_edibleGrid.move(a, oldX, oldY, a->getX(), a->getY());
+	if (indexes & INDEX_BLOCKING)
+		m_blockingGrid.move(a, oldX, oldY, a->getX(), a->getY());
+}
+
+Actor* StudentWorld::getOverlappingEdible(double x, double y) const
+{
+	return earliestInRadius(m_edibleGrid, x, y, SPRITE_WIDTH, true);	//food already eaten this tick stays in the grid until the sweep
 }
 
-bool StudentWorld::checkForMovePossible(double x, double y)
+bool StudentWorld::checkForMovePossible(double x, double y) const
 {
+	OccupancyMask::Result cached = m_dirtMask.lookup(x, y);	//almost every point is decided by the precomputed mask
+	if (cached != OccupancyMask::UNKNOWN)
+		return cached == OccupancyMask::FREE;
 	double xDistance = VIEW_WIDTH / 2 - x;
 	double yDistance = VIEW_HEIGHT / 2 - y;
 	double distanceFromCenter = sqrt(xDistance * xDistance + yDistance * yDistance);
 	if (distanceFromCenter > VIEW_RADIUS)	//if move would take object past view_radius from the center, it is not possible
 		return false;
-	for (int i = 0; i < m_gameObjects.size(); i++)		//cannot make move if it would tmake the object overlap with dirt
-	{
-		if (m_gameObjects[i]->doesOverLap(x, y, SPRITE_WIDTH / 2) && m_gameObjects[i]->blocksMovement())
-			return false;
-	}
-	return true;
+	return firstInRadius(m_blockingGrid, x, y, SPRITE_WIDTH / 2) == nullptr;		//cannot make move if it would make the object overlap with dirt
 }
 
 Socrates* StudentWorld::giveSocrates()
@@ -229,34 +487,46 @@ Socrates* StudentWorld::giveSocrates()
 
 bool StudentWorld::getAngleToNearestNearbyEdible(Actor* a, int dist, int& angle) const
 {
-	double shortestDistance = dist;
-	bool edibleFound = false;
-	for (int i = 0; i < m_gameObjects.size(); i++)
+	double shortestDistance2 = double(dist) * dist;	//squared, the kernels never take a sqrt
+	Actor* nearest = nullptr;
+	m_edibleGrid.forEachCellNear(a->getX(), a->getY(), dist, [&](const SpatialGrid::Cell& cell)
 	{
-		if (m_gameObjects[i]->isEdible())
+		double cellDistance2 = shortestDistance2;
+		if (nearestWithinRadius(cell.xs.data(), cell.ys.data(), cell.size(), a->getX(), a->getY(), cellDistance2) < 0)
+			return false;	//nothing in this cell is as close as the nearest so far
+		if (cellDistance2 < shortestDistance2)
 		{
-			double xDistance = (m_gameObjects[i]->getX() - a->getX());
-			double yDistance = (m_gameObjects[i]->getY() - a->getY());
-			double edibleDistance = sqrt(xDistance * xDistance + yDistance * yDistance);	//calculate distance from object to food
-			if (edibleDistance <= shortestDistance)
-			{
-				shortestDistance = edibleDistance;	
-				angle = atan2(yDistance, xDistance) * (180 / PI);	//set angle to angle between the object and the food
-				edibleFound = true;
-			}
+			shortestDistance2 = cellDistance2;
+			nearest = nullptr;
 		}
-	}
-	return edibleFound;
+		for (int start = 0; start < cell.size(); )	//every food at that distance, keeping the one added to the world last, as when the world was searched in order
+		{
+			int i = firstWithinRadius(cell.xs.data() + start, cell.ys.data() + start, cell.size() - start, a->getX(), a->getY(), cellDistance2);
+			if (i < 0)
+				break;
+			Actor* e = cell.actors[start + i];
+			if (nearest == nullptr || e->worldOrder() > nearest->worldOrder())
+				nearest = e;
+			start += i + 1;
+		}
+		return false;
+	});
+	if (nearest == nullptr)
+		return false;
+	Fixed xDistance = toFixed(nearest->getX()) - toFixed(a->getX());
+	Fixed yDistance = toFixed(nearest->getY()) - toFixed(a->getY());
+	angle = degreesToward(xDistance, yDistance);	//set angle to angle between the object and the food
+	return true;
 }
 
 bool StudentWorld::getAngleToNearbySocrates(Actor* a, int dist, int& angle) const
 {
 	double xDistance = m_Soc->getX() - a->getX();
 	double yDistance = m_Soc->getY() - a->getY();
-	double socDistance = sqrt(xDistance * xDistance + yDistance * yDistance);	//calculate distance between object and socrates
-	if (socDistance <= dist)	//if distance if within specified distance, set angle to angle between the object and socrates
+	double socDistance2 = xDistance * xDistance + yDistance * yDistance;	//calculate squared distance between object and socrates
+	if (socDistance2 <= double(dist) * dist)	//if distance if within specified distance, set angle to angle between the object and socrates
 	{
-		angle = atan2(yDistance, xDistance) * (180 / PI);
+		angle = degreesToward(toFixed(m_Soc->getX()) - toFixed(a->getX()), toFixed(m_Soc->getY()) - toFixed(a->getY()));
 		return true;
 	}
 	return false;
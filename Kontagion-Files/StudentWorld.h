@@ -2,41 +2,115 @@
 #define STUDENTWORLD_H_
 
 #include "GameWorld.h"
+#include "SpatialGrid.h"
+#include "OccupancyMask.h"
+#include "Random.h"
+#include "ProjectileSystem.h"
+#include "PlacementSampler.h"
+#include "TaskScheduler.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
 class Actor;
-class Projectile;
 class Socrates;
 class Bacterium;
 
+enum ActorType		//every concrete kind of actor, used for the world's population counts
+{
+	ACTOR_SOCRATES,
+	ACTOR_DIRT,
+	ACTOR_FOOD,
+	ACTOR_PIT,
+	ACTOR_SPRAY,
+	ACTOR_FLAME,
+	ACTOR_HEALTH_GOODIE,
+	ACTOR_FLAME_THROWER_GOODIE,
+	ACTOR_EXTRA_LIFE_GOODIE,
+	ACTOR_FUNGUS,
+	ACTOR_REGULAR_SALMONELLA,
+	ACTOR_AGGRESSIVE_SALMONELLA,
+	ACTOR_ECOLI,
+	NUM_ACTOR_TYPES
+};
+
 // Students:  Add code to this file, StudentWorld.cpp, Actor.h, and Actor.cpp
 class Actor;
 class StudentWorld : public GameWorld
 {
 public:
-    StudentWorld(std::string assetPath);
+    StudentWorld(std::string assetPath, std::uint64_t seed);
 	~StudentWorld();
     virtual int init();
     virtual int move();
     virtual void cleanUp();
 	bool checkForOverLap(double x, double y, double distance);	//check if objects overlap at given location
-	void findStartLoc(double& startX, double& startY);		//find an init location that does not overlap where not allowed
+	bool findStartLoc(double& startX, double& startY);		//find an init location that does not overlap where not allowed, false if none is left
 	bool damageObject(double xLoc, double yLoc, double damage);		//damage an object with projectile
 	void addActor(Actor* a);
-	Actor* getOverlappingEdible(Actor* a);		//return overlapping food
-	bool checkForMovePossible(double x, double y);	//check if a move isblocked by dirt
+	void actorDied(const Actor* a);		//called once as an actor is set dead
+	void launchProjectile(ProjectileSystem::Kind kind, double x, double y, int direction);	//fire a spray or flame
+	void actorMoved(Actor* a, double oldX, double oldY);	//update the spatial grid after an actor moves
+	Actor* getOverlappingEdible(double x, double y) const;		//return living food overlapping a bacterium at x, y
+	bool checkForMovePossible(double x, double y) const;	//check if a move isblocked by dirt
 	Socrates* giveSocrates();
 	bool getAngleToNearestNearbyEdible(Actor* a, int dist, int& angle) const;	//find angle to nearest food within distance
 	bool getAngleToNearbySocrates(Actor* a, int dist, int& angle) const;	//find angle to socrates within distance
+	RandomStream spawnStream();		//random stream for a newly constructed actor
+	RandomStream* setSpawnParent(RandomStream* parent);	//stream new actors split from until the next call, returns the previous one
+	std::uint64_t seed() const;
+	int actorsReclaimedLastTick() const;	//number of dead objects freed by the last sweep
+	int actorCount(ActorType type) const;		//live population of one type, dead objects count until the end of tick sweep
+	int pitsRemaining() const;		//pits still preventing the level from completing
+	int bacteriaRemaining() const;	//bacteria still preventing the level from completing
+	bool countsMatchRecount() const;	//walk every object and check the population counters against it
 
 private:
+	void removeDeadActors();	//sweep dead objects out of the world in one pass
+	int removeDead(std::vector<Actor*>& actors);	//free the dead actors of one list, return how many
+	bool updateActorsInOrder();		//each actor acts in turn and sees what earlier ones did, false if socrates died
+	bool updateActorsInTwoPhases(TaskScheduler& scheduler);	//every actor plans in parallel, then commits in turn, false if socrates died
+	Actor* findDamageable(double x, double y) const;	//first damageable object a projectile at x, y would hit
+	Actor* firstInRadius(const SpatialGrid& grid, double x, double y, double radius, bool aliveOnly = false) const;	//first object of a grid within radius of x, y
+	Actor* earliestInRadius(const SpatialGrid& grid, double x, double y, double radius, bool aliveOnly = false) const;	//same, but the earliest in world order when several are
+	int indexesOf(const Actor* a) const;	//which capability indexes an actor belongs in
+	void indexActor(Actor* a);
+	void unindexActor(Actor* a);
+	void countActor(const Actor* a, int indexes, int delta);	//update the population counters on spawn and death
+
+	enum
+	{
+		INDEX_SOLID = 1,			//cannot be overlapped by newly placed objects
+		INDEX_DAMAGEABLE = 2,
+		INDEX_EDIBLE = 4,
+		INDEX_BLOCKING = 8,
+		INDEX_LEVEL_BLOCKING = 16
+	};
+
 	Socrates* m_Soc = nullptr;
-	std::vector<Actor*> m_gameObjects;
+	std::uint64_t m_seed;
+	RandomStream m_spawnRandom;		//parent of actors the world itself creates
+	RandomStream m_placementRandom;	//start locations in init
+	PlacementSampler m_placement;	//candidate start locations not yet ruled out this level
+	RandomStream m_goodieRandom;	//goodie and fungus rolls and locations
+	RandomStream* m_spawnParent;	//stream new actors split from, the acting actor's during its turn
+	std::vector<Actor*> m_gameObjects;		//actors that take a turn each tick
+	std::vector<Actor*> m_inertObjects;		//dirt and food, in the grids and mask but never ticked
+	bool m_inertDied = false;		//whether the sweep has to look through m_inertObjects
+	unsigned long long m_nextWorldOrder = 0;
+	int m_actorsReclaimed = 0;
+	SpatialGrid m_solidGrid;		//objects of m_gameObjects bucketed by location, one grid per capability so
+	SpatialGrid m_damageableGrid;	//each query only visits the objects it could match
+	SpatialGrid m_edibleGrid;
+	SpatialGrid m_blockingGrid;
+	ProjectileSystem m_projectiles;		//sprays and flames live here rather than in m_gameObjects
+	OccupancyMask m_dirtMask;		//rasterized dirt and arena edge for checkForMovePossible, patched as dirt is added and removed
+	int m_actorCounts[NUM_ACTOR_TYPES] = {};
+	int m_pitsRemaining = 0;
+	int m_bacteriaRemaining = 0;
 };
 
-void pickRandLoc(double& x, double& y);
-void goodieStartLoc(double& X, double& Y);
+void goodieStartLoc(RandomStream& random, double& X, double& Y);
 
 
 #endif // STUDENTWORLD_H_
@@ -0,0 +1,116 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+TaskScheduler::TaskScheduler(int threads)
+	: m_body(nullptr), m_remaining(0), m_generation(0), m_stopping(false)
+{
+	threads = std::max(threads, 1);
+	for (int i = 0; i < threads; i++)
+		m_queues.push_back(std::unique_ptr<Queue>(new Queue));
+	for (int i = 1; i < threads; i++)		//the caller is thread 0 and needs no thread of its own
+		m_threads.emplace_back(&TaskScheduler::workerMain, this, i);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_stateLock);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	for (std::size_t i = 0; i < m_threads.size(); i++)
+		m_threads[i].join();
+}
+
+int TaskScheduler::threadCount() const
+{
+	return static_cast<int>(m_queues.size());
+}
+
+void TaskScheduler::run(int count, int grain, const std::function<void(int, int)>& body)
+{
+	if (count <= 0)
+		return;
+	grain = std::max(grain, 1);
+	if (m_threads.empty() || count <= grain)		//not worth waking anyone
+	{
+		body(0, count);
+		return;
+	}
+
+	int ranges = (count + grain - 1) / grain;
+	m_body = &body;
+	m_remaining = ranges;
+	for (int r = 0; r < ranges; r++)
+	{
+		Queue& queue = *m_queues[r % m_queues.size()];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.ranges.push_back(Range{ r * grain, std::min(count, (r + 1) * grain) });
+	}
+	{
+		std::lock_guard<std::mutex> guard(m_stateLock);
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	work(0);
+	std::unique_lock<std::mutex> lock(m_stateLock);		//others may still be finishing ranges they took
+	m_done.wait(lock, [this]() { return m_remaining == 0; });
+	m_body = nullptr;
+}
+
+bool TaskScheduler::takeRange(int self, Range& range)
+{
+	{
+		Queue& own = *m_queues[self];		//newest first from our own queue
+		std::lock_guard<std::mutex> guard(own.lock);
+		if (!own.ranges.empty())
+		{
+			range = own.ranges.back();
+			own.ranges.pop_back();
+			return true;
+		}
+	}
+	for (std::size_t k = 1; k < m_queues.size(); k++)		//then oldest first from everyone else's
+	{
+		Queue& victim = *m_queues[(self + k) % m_queues.size()];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.ranges.empty())
+		{
+			range = victim.ranges.front();
+			victim.ranges.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::work(int self)
+{
+	Range range;
+	while (takeRange(self, range))
+	{
+		(*m_body)(range.begin, range.end);
+		if (--m_remaining == 0)
+		{
+			std::lock_guard<std::mutex> guard(m_stateLock);
+			m_done.notify_one();
+		}
+	}
+}
+
+void TaskScheduler::workerMain(int self)
+{
+	std::uint64_t seen = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_stateLock);
+			m_wake.wait(lock, [&]() { return m_stopping || m_generation != seen; });
+			if (m_stopping)
+				return;
+			seen = m_generation;
+		}
+		work(self);
+	}
+}
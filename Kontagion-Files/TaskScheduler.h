@@ -0,0 +1,73 @@
+#ifndef TASKSCHEDULER_H_
+#define TASKSCHEDULER_H_
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+// A fixed set of worker threads for splitting one loop across cores. A
+// parallelFor cuts its range into chunks and deals them out round robin, one
+// queue per thread; each thread works through its own queue from the back and,
+// once it runs dry, steals from the front of the others, so a thread that drew
+// cheap chunks helps out instead of idling. The calling thread works too, and
+// parallelFor returns once every chunk has run. Which thread runs a chunk is
+// not deterministic, so the loop body should only write results for its own
+// indices. One parallelFor runs at a time, and only from a single thread.
+class TaskScheduler
+{
+public:
+	explicit TaskScheduler(int threads);		//threads includes the caller, so 1 runs everything on the calling thread
+	~TaskScheduler();
+
+	int threadCount() const;
+
+	// Calls f(begin, end) over chunks of at most grain indices covering [0, count).
+	template<typename Func>
+	void parallelFor(int count, int grain, Func f);
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+private:
+	struct Range
+	{
+		int begin;
+		int end;
+	};
+
+	struct Queue
+	{
+		std::mutex lock;
+		std::deque<Range> ranges;
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_queues;		//one per thread, the caller's is 0
+	std::vector<std::thread> m_threads;
+	const std::function<void(int, int)>* m_body;	//the running loop, published before its ranges are queued
+	std::atomic<int> m_remaining;		//ranges of the running loop not yet finished
+
+	std::mutex m_stateLock;
+	std::condition_variable m_wake;		//workers wait here for the next loop
+	std::condition_variable m_done;		//the caller waits here for the last range
+	std::uint64_t m_generation;
+	bool m_stopping;
+
+	void run(int count, int grain, const std::function<void(int, int)>& body);
+	bool takeRange(int self, Range& range);
+	void work(int self);		//run ranges until none are left anywhere
+	void workerMain(int self);
+};
+
+template<typename Func>
+void TaskScheduler::parallelFor(int count, int grain, Func f)
+{
+	run(count, grain, std::function<void(int, int)>(f));
+}
+
+#endif // TASKSCHEDULER_H_
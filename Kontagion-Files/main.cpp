@@ -1,7 +1,13 @@
 #include "GameController.h"
+#include "AssetPack.h"
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <memory>
 using namespace std;
 
 #ifdef _MSC_VER
@@ -28,10 +34,52 @@ const string assetDirectory = "Assets";
 
 class GameWorld;
 
-GameWorld* createStudentWorld(string assetPath = "");
+GameWorld* createStudentWorld(string assetPath, uint64_t seed);
+
+  // Pull "--flag VALUE" out of the arguments so GLUT never sees it, and
+  // return VALUE, or null if the flag isn't there.  The game takes:
+  //   --seed N          without a seed every game is different; with one the
+  //                     same keys replay the same game
+  //   --sound-file PATH record the mixed sound to that .wav file, which is the
+  //                     only way to hear it where no sound device is used
+  //   --tick-rate N     the world ticks N times a second however fast the
+  //                     frames are drawn
+
+static const char* takeOptionValue(int& argc, char* argv[], const char* flag)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], flag) == 0)
+        {
+            const char* value = argv[i+1];
+            for (int j = i; j + 2 <= argc; j++)
+                argv[j] = argv[j+2];
+            argc -= 2;
+            return value;
+        }
+    }
+    return nullptr;
+}
 
 int main(int argc, char* argv[])
 {
+    uint64_t seed;
+    if (const char* value = takeOptionValue(argc, argv, "--seed"))
+        seed = strtoull(value, nullptr, 10);
+    else
+    {
+        random_device rd;
+        seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
+
+    const char* soundFileValue = takeOptionValue(argc, argv, "--sound-file");
+    string soundFile = soundFileValue != nullptr ? soundFileValue : "";
+
+    const char* tickRateValue = takeOptionValue(argc, argv, "--tick-rate");
+    int tickRate = tickRateValue != nullptr ? atoi(tickRateValue) : 0;
+    if (tickRate <= 0)
+        tickRate = GameController::DEFAULT_TICKS_PER_SECOND;
+
     string assetPath = assetDirectory;
     if (!assetPath.empty())
     {
@@ -42,7 +90,13 @@ int main(int argc, char* argv[])
         }
         assetPath += '/';
     }
+
+      // A pack built from the loose files is preferred; without one the
+      // loose files must be there
+    unique_ptr<AssetPack> pack(new AssetPack);
+    if (!pack->open(assetPath + ASSET_PACK_FILE))
     {
+        pack.reset();
         const string someAsset = "socrates.tga";
         ifstream ifs(assetPath + someAsset);
         if (!ifs)
@@ -53,6 +107,9 @@ int main(int argc, char* argv[])
         }
     }
 
-    GameWorld* gw = createStudentWorld(assetPath);
+    GameWorld* gw = createStudentWorld(assetPath, seed);
+    Game().setAssetPack(move(pack));
+    Game().setSoundFile(soundFile);
+    Game().setTickRate(tickRate);
     Game().run(argc, argv, gw, "Kontagion");
 }
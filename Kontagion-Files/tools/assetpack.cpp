@@ -0,0 +1,67 @@
+  // Kontagion asset packer: builds the sprite atlas from the loose .tga files
+  // in an Assets directory and writes it, with every .wav the game plays,
+  // into one asset pack.  The game loads the pack, when it finds one, with
+  // no decoding, packing or filtering.  Build it from this file and the same
+  // sources as the headless driver (see README.md).
+
+#include "../AssetPack.h"
+#include "../SpriteAtlas.h"
+#include "../MappedFile.h"
+#include "../TaskScheduler.h"
+#include "../GameConstants.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <algorithm>
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        cout << "usage: " << argv[0] << " ASSETDIR OUTPUT" << endl
+             << "  e.g. " << argv[0] << " Assets Assets/" << ASSET_PACK_FILE << endl;
+        return 1;
+    }
+    string assetPath = string(argv[1]) + "/";
+    string output = argv[2];
+
+    AssetPackWriter writer;
+    {
+        TaskScheduler scheduler(max(1, static_cast<int>(thread::hardware_concurrency())));
+        SpriteAtlas atlas;
+        SpriteAtlas::LoadTimes times;
+        string error;
+        if (!atlas.load(assetPath, scheduler, times, error))
+        {
+            cout << error << endl;
+            return 1;
+        }
+        atlas.save(writer);
+        const SpriteAtlas::Level& top = atlas.levels()[0];
+        cout << "atlas: " << top.width << "x" << top.height << ", "
+             << atlas.levels().size() << " levels" << endl;
+    }
+
+      // Several sounds may share a file; the pack holds it once
+    int sounds = 0;
+    for (const SoundInfo& s : SOUND_INFO)
+    {
+        MappedFile file;
+        if (!file.open(assetPath + s.fileName))
+        {
+            cout << "Cannot open " << assetPath + s.fileName << endl;
+            return 1;
+        }
+        if (writer.add(s.fileName, file.data(), file.size()))
+            sounds++;
+    }
+    cout << "sounds: " << sounds << endl;
+
+    if (!writer.write(output))
+    {
+        cout << "Cannot write " << output << endl;
+        return 1;
+    }
+    return 0;
+}
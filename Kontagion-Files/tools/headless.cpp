@@ -0,0 +1,401 @@
+  // Headless Kontagion driver: ticks StudentWorlds with no window or GLUT,
+  // taking input from a key script or a built-in bot, and reports how fast
+  // the simulation ran.  With --worlds it plays many independently seeded
+  // worlds on a pool of threads and reports the aggregate rate.  With
+  // --tick-threads each world splits its own ticks across threads, and
+  // --check-tick-threads confirms the thread count never changes the game.
+  // With --assets its sounds go through the AudioMixer, into --sound-file if
+  // given.  Build it from this file, HeadlessController.cpp, GameWorld.cpp
+  // and the world sources (see README.md).
+
+#include "../HeadlessController.h"
+#include "../GameWorld.h"
+#include "../StudentWorld.h"
+#include "../GameConstants.h"
+#include "../ActorPool.h"
+#include "../FixedPoint.h"
+#include "../TaskScheduler.h"
+#include "../AudioMixer.h"
+#include "../AssetPack.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+using namespace std;
+
+GameWorld* createStudentWorld(string assetPath, uint64_t seed);
+
+static void usage()
+{
+    cout << "usage: kontagion-headless [--seed N] [--ticks N] [--level N] [--script FILE | --bot]" << endl
+         << "                          [--worlds N [--threads N]] [--tick-threads N]" << endl
+         << "                          [--check-tick-threads]" << endl
+         << "                          [--assets DIR [--sound-file FILE]]" << endl
+         << "  --seed N      world random seed (default 1), equal seeds give identical runs" << endl
+         << "  --ticks N     stop each world after N moves (default 10000)" << endl
+         << "  --level N     start at level N (default 1)" << endl
+         << "  --script FILE one key per tick: left right space enter none, optionally" << endl
+         << "                prefixed with a repeat count, e.g. 20*left" << endl
+         << "  --bot         built-in bot that circles, sprays and uses flames" << endl
+         << "  --worlds N    play N worlds seeded seed, seed+1, ... and report totals" << endl
+         << "  --threads N   worker threads for --worlds (default: hardware threads)" << endl
+         << "  --tick-threads N  plan each tick on N threads and commit in order; every N" << endl
+         << "                of 1 or more gives the same game, which differs from that of the" << endl
+         << "                default 0, where actors act one at a time" << endl
+         << "  --check-tick-threads  play the world with 1 and with 4 tick threads and" << endl
+         << "                fail unless the games are identical" << endl
+         << "  --assets DIR  load the sounds from DIR (or its asset pack) and mix them as the game plays" << endl
+         << "  --sound-file FILE  record the mix to FILE (.wav); needs --assets" << endl;
+}
+
+static bool parseKey(const string& name, int& key)
+{
+    if (name == "left")       key = KEY_PRESS_LEFT;
+    else if (name == "right") key = KEY_PRESS_RIGHT;
+    else if (name == "space") key = KEY_PRESS_SPACE;
+    else if (name == "enter") key = KEY_PRESS_ENTER;
+    else if (name == "none" || name == ".") key = INVALID_KEY;
+    else return false;
+    return true;
+}
+
+static bool loadScript(const string& fileName, vector<int>& keys)
+{
+    ifstream ifs(fileName);
+    if (!ifs)
+    {
+        cout << "Cannot open script " << fileName << endl;
+        return false;
+    }
+    string token;
+    while (ifs >> token)
+    {
+        int repeat = 1;
+        string::size_type star = token.find('*');
+        if (star != string::npos)
+        {
+            repeat = atoi(token.substr(0, star).c_str());
+            token = token.substr(star + 1);
+        }
+        int key;
+        if (!parseKey(token, key) || repeat < 0)
+        {
+            cout << "Bad script token " << token << endl;
+            return false;
+        }
+        keys.insert(keys.end(), repeat, key);
+    }
+    return true;
+}
+
+  // Sweeps back and forth around the dish spraying, and lights a flame ring now and then
+static int botKey(long tick)
+{
+    if (tick % 400 == 0)
+        return KEY_PRESS_ENTER;
+    if (tick % 3 == 0)
+        return KEY_PRESS_SPACE;
+    return (tick / 60) % 2 == 0 ? KEY_PRESS_LEFT : KEY_PRESS_RIGHT;
+}
+
+  // What the driver watches in the world itself, tick by tick
+struct WorldTally
+{
+    long reclaimed = 0;         // dead actors freed by the end of tick sweeps
+    int  mostReclaimed = 0;     // by any one sweep
+    int  population[NUM_ACTOR_TYPES] = {};  // as the world counted it after the last move
+    int  pitsRemaining = 0;
+    int  bacteriaRemaining = 0;
+    long countMismatches = 0;   // ticks whose counters disagreed with a recount
+    uint64_t trace = 14695981039346656037ull;  // hash of every tick's score and counts, equal only for equal games
+};
+
+static void addToTrace(uint64_t& trace, long value)
+{
+    trace = (trace ^ static_cast<uint64_t>(value)) * 1099511628211ull;
+}
+
+static void tallyTick(GameWorld* gw, WorldTally& tally)
+{
+    const StudentWorld* sw = static_cast<const StudentWorld*>(gw);
+    tally.reclaimed += sw->actorsReclaimedLastTick();
+    tally.mostReclaimed = max(tally.mostReclaimed, sw->actorsReclaimedLastTick());
+    for (int type = 0; type < NUM_ACTOR_TYPES; type++)
+        tally.population[type] = sw->actorCount(static_cast<ActorType>(type));
+    tally.pitsRemaining = sw->pitsRemaining();
+    tally.bacteriaRemaining = sw->bacteriaRemaining();
+    if (!sw->countsMatchRecount())
+        tally.countMismatches++;
+    addToTrace(tally.trace, gw->getScore());
+    addToTrace(tally.trace, gw->getLives());
+    addToTrace(tally.trace, sw->actorsReclaimedLastTick());
+    for (int count : tally.population)
+        addToTrace(tally.trace, count);
+}
+
+static void printResults(uint64_t seed, const HeadlessController::Results& r, const WorldTally& tally)
+{
+    ostringstream oss;
+    oss << "seed: " << seed
+        << "  ticks: " << r.ticks
+        << "  seconds: " << r.seconds
+        << "  ticks/sec: " << (r.seconds > 0 ? r.ticks / r.seconds : 0) << endl
+        << "levels completed: " << r.levelsCompleted
+        << "  lives lost: " << r.livesLost
+        << "  final level: " << r.finalLevel
+        << "  final score: " << r.finalScore
+        << "  sounds: " << r.soundsPlayed << " of " << r.soundRequests
+        << (r.gameOver ? (r.playerWon ? "  (won)" : "  (game over)") : "") << endl;
+    oss << "actors reclaimed: " << tally.reclaimed
+        << "  per tick: " << (r.ticks > 0 ? double(tally.reclaimed) / r.ticks : 0)
+        << "  most in one tick: " << tally.mostReclaimed << endl;
+    const int* n = tally.population;
+    oss << "last population: dirt " << n[ACTOR_DIRT]
+        << "  food " << n[ACTOR_FOOD]
+        << "  pits " << n[ACTOR_PIT]
+        << "  bacteria " << n[ACTOR_REGULAR_SALMONELLA] + n[ACTOR_AGGRESSIVE_SALMONELLA] + n[ACTOR_ECOLI]
+        << "  goodies " << n[ACTOR_HEALTH_GOODIE] + n[ACTOR_FLAME_THROWER_GOODIE] + n[ACTOR_EXTRA_LIFE_GOODIE] + n[ACTOR_FUNGUS]
+        << "  sprays " << n[ACTOR_SPRAY]
+        << "  flames " << n[ACTOR_FLAME] << endl
+        << "level blockers: pits " << tally.pitsRemaining
+        << "  bacteria " << tally.bacteriaRemaining
+        << "  counter mismatches: " << tally.countMismatches << " of " << r.ticks << " ticks" << endl;
+    ActorPool::Stats pool = ActorPool::local().stats();
+    oss << "actor pool: in use " << pool.inUse
+        << "  high water " << pool.highWater
+        << "  reserved " << pool.reserved
+        << " slots in " << pool.chunks << " chunks" << endl;
+#ifdef KONTAGION_CHECK_FIXED_POINT
+    FixedPointCheckStats check = fixedPointCheckStats();
+    oss << "fixed point check: " << check.checks << " steps"
+        << "  mismatches " << check.mismatches
+        << "  max error " << check.maxError << endl;
+#endif
+    cout << oss.str();
+}
+
+static HeadlessController::Results playWorld(uint64_t seed, long maxTicks, int startLevel, int tickThreads,
+                                             const HeadlessController::KeySource& keys,
+                                             WorldTally& tally, AudioMixer* audio = nullptr)
+{
+    HeadlessController controller;
+    controller.setKeySource(keys);
+    controller.setAudio(audio);
+    controller.setTickObserver([&tally](GameWorld* gw) { tallyTick(gw, tally); });
+
+    unique_ptr<TaskScheduler> scheduler;
+    GameWorld* gw = createStudentWorld("", seed);
+    if (tickThreads > 0)
+    {
+        scheduler.reset(new TaskScheduler(tickThreads));
+        gw->setTaskScheduler(scheduler.get());
+    }
+    for (int level = 1; level < startLevel; level++)
+        gw->advanceToNextLevel();
+
+    HeadlessController::Results r = controller.run(gw, maxTicks);
+    delete gw;
+    return r;
+}
+
+  // Every world owns all of its state, so worlds are simply handed out to
+  // worker threads one at a time until none are left.
+static int runBatch(uint64_t firstSeed, int worlds, int threads, long maxTicks, int startLevel, int tickThreads,
+                    const HeadlessController::KeySource& keys)
+{
+    vector<HeadlessController::Results> results(worlds);
+    vector<WorldTally> tallies(worlds);
+    atomic<int> nextWorld(0);
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&]() {
+            for (int w = nextWorld++; w < worlds; w = nextWorld++)
+                results[w] = playWorld(firstSeed + w, maxTicks, startLevel, tickThreads, keys, tallies[w]);
+        });
+    }
+    for (thread& t : pool)
+        t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long totalTicks = 0;
+    long totalScore = 0;
+    int minScore = results[0].finalScore;
+    int maxScore = results[0].finalScore;
+    int levelErrors = 0;
+    int gamesOver = 0;
+    long reclaimed = 0;
+    long countMismatches = 0;
+    for (const WorldTally& tally : tallies)
+    {
+        reclaimed += tally.reclaimed;
+        countMismatches += tally.countMismatches;
+    }
+    for (const HeadlessController::Results& r : results)
+    {
+        totalTicks += r.ticks;
+        totalScore += r.finalScore;
+        minScore = min(minScore, r.finalScore);
+        maxScore = max(maxScore, r.finalScore);
+        levelErrors += r.levelError;
+        gamesOver += r.gameOver;
+    }
+
+    ostringstream oss;
+    oss << "worlds: " << worlds
+        << "  threads: " << threads
+        << "  seeds: " << firstSeed << "-" << firstSeed + worlds - 1 << endl
+        << "total ticks: " << totalTicks
+        << "  seconds: " << seconds
+        << "  aggregate ticks/sec: " << (seconds > 0 ? totalTicks / seconds : 0) << endl
+        << "score min/mean/max: " << minScore << "/" << double(totalScore) / worlds << "/" << maxScore
+        << "  games over: " << gamesOver
+        << "  level errors: " << levelErrors << endl
+        << "actors reclaimed: " << reclaimed
+        << "  per tick: " << (totalTicks > 0 ? double(reclaimed) / totalTicks : 0)
+        << "  counter mismatches: " << countMismatches << endl;
+    cout << oss.str();
+    return levelErrors == 0 && countMismatches == 0 ? 0 : 1;
+}
+
+  // Planning spreads over however many threads there are, and everything
+  // that depends on order happens in the commit, so the thread count must
+  // never show in the game.
+static int checkTickThreads(uint64_t seed, long maxTicks, int startLevel, const HeadlessController::KeySource& keys)
+{
+    const int counts[2] = { 1, 4 };
+    HeadlessController::Results r[2];
+    WorldTally tally[2];
+    for (int k = 0; k < 2; k++)
+        r[k] = playWorld(seed, maxTicks, startLevel, counts[k], keys, tally[k]);
+
+    bool same = r[0].ticks == r[1].ticks  &&  r[0].finalScore == r[1].finalScore  &&
+                r[0].livesLost == r[1].livesLost  &&  r[0].levelsCompleted == r[1].levelsCompleted  &&
+                r[0].soundsPlayed == r[1].soundsPlayed  &&  tally[0].trace == tally[1].trace;
+    for (int k = 0; k < 2; k++)
+        cout << "tick threads " << counts[k] << ": ticks " << r[k].ticks
+             << "  final score " << r[k].finalScore
+             << "  lives lost " << r[k].livesLost
+             << "  sounds " << r[k].soundsPlayed
+             << "  trace " << hex << tally[k].trace << dec << endl;
+    cout << (same ? "same game" : "games differ") << endl;
+    return same ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t seed = 1;
+    long maxTicks = 10000;
+    int startLevel = 1;
+    string scriptFile;
+    bool useBot = false;
+    int worlds = 0;
+    int threads = max(1u, thread::hardware_concurrency());
+    int tickThreads = 0;
+    bool checkThreads = false;
+    string assetDir;
+    string soundFile;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--ticks" && i + 1 < argc)
+            maxTicks = atol(argv[++i]);
+        else if (arg == "--level" && i + 1 < argc)
+            startLevel = atoi(argv[++i]);
+        else if (arg == "--script" && i + 1 < argc)
+            scriptFile = argv[++i];
+        else if (arg == "--bot")
+            useBot = true;
+        else if (arg == "--worlds" && i + 1 < argc)
+            worlds = atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = max(1, atoi(argv[++i]));
+        else if (arg == "--tick-threads" && i + 1 < argc)
+            tickThreads = max(0, atoi(argv[++i]));
+        else if (arg == "--check-tick-threads")
+            checkThreads = true;
+        else if (arg == "--assets" && i + 1 < argc)
+            assetDir = argv[++i];
+        else if (arg == "--sound-file" && i + 1 < argc)
+            soundFile = argv[++i];
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    vector<int> script;
+    if (!scriptFile.empty() && !loadScript(scriptFile, script))
+        return 1;
+
+    HeadlessController::KeySource keys;
+    if (!scriptFile.empty())
+        keys = [&script](long tick) {
+            return tick < static_cast<long>(script.size()) ? script[tick] : INVALID_KEY;
+        };
+    else if (useBot)
+        keys = botKey;
+
+    if (checkThreads)
+        return checkTickThreads(seed, maxTicks, startLevel, keys);
+    if (worlds > 0)
+        return runBatch(seed, worlds, threads, maxTicks, startLevel, tickThreads, keys);
+
+      // The mixer runs in real time while the game runs flat out, so a
+      // recording is what a player would hear only of a short run.
+    unique_ptr<AudioMixer> audio;
+    if (!assetDir.empty())
+    {
+        unique_ptr<AudioSink> sink(new NullAudioSink);
+        if (!soundFile.empty())
+        {
+            unique_ptr<WavFileAudioSink> file(new WavFileAudioSink(soundFile, AudioMixer::SAMPLE_RATE));
+            if (!file->isOpen())
+            {
+                cout << "Cannot write " << soundFile << endl;
+                return 1;
+            }
+            sink = move(file);
+        }
+        audio.reset(new AudioMixer(move(sink)));
+        AssetPack pack;
+        bool packed = pack.open(assetDir + "/" + ASSET_PACK_FILE);
+        int failed = audio->loadGameSounds(assetDir + "/", packed ? &pack : nullptr);
+        if (failed > 0)
+            cout << failed << " sound(s) could not be loaded" << endl;
+        audio->start();
+    }
+
+    WorldTally tally;
+    HeadlessController::Results r = playWorld(seed, maxTicks, startLevel, tickThreads, keys, tally, audio.get());
+    if (r.levelError)
+    {
+        cout << "Level could not be initialized" << endl;
+        return 1;
+    }
+    printResults(seed, r, tally);
+    if (audio != nullptr)
+    {
+        AudioMixer::Stats s = audio->stats();
+        cout << "audio: played " << s.played
+             << "  dropped " << s.dropped
+             << "  stolen " << s.stolen
+             << "  skipped " << s.skipped
+             << "  blocks mixed " << s.blocksMixed << endl;
+    }
+    return tally.countMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+  // Kontagion microbenchmarks: times the DistanceKernels against the
+  // per-object path they replaced, where each candidate is a heap Actor
+  // asked through virtual calls whether it overlaps a point, and the
+  // fixed-point direction table against the cos and sin every move used to
+  // take.  With --dirt-sweep it instead times move checks and whole ticks in
+  // worlds holding more and more dirt.  Build it from this file and the same
+  // sources as the headless driver (see README.md).
+
+#include "../StudentWorld.h"
+#include "../Actor.h"
+#include "../DistanceKernels.h"
+#include "../Random.h"
+#include "../FixedPoint.h"
+#include "../HeadlessController.h"
+#include "../GameConstants.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+using namespace std;
+
+namespace
+{
+    const int ROUNDS = 5;   // best of, to ride out scheduler noise
+
+    struct Candidates
+    {
+        vector<double> xs;
+        vector<double> ys;
+        vector<Actor*> actors;
+    };
+
+    struct Timing
+    {
+        double nsPerItem;
+        long checksum;      // hits found, so both paths can be compared and nothing is optimized away
+    };
+
+    template<typename Func>
+    Timing timeIt(long itemsPerRound, Func f)
+    {
+        Timing best = { 0, 0 };
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            auto start = chrono::steady_clock::now();
+            long checksum = f();
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            double perItem = ns / itemsPerRound;
+            if (round == 0 || perItem < best.nsPerItem)
+                best.nsPerItem = perItem;
+            best.checksum = checksum;
+        }
+        return best;
+    }
+
+    void report(const string& name, const Timing& kernel, const Timing& virtualPath,
+                const string& kernelName = "kernel", const string& virtualName = "virtual")
+    {
+        ostringstream oss;
+        oss << name << ": " << kernelName << " " << kernel.nsPerItem << " ns"
+            << "  " << virtualName << " " << virtualPath.nsPerItem << " ns"
+            << "  speedup " << (kernel.nsPerItem > 0 ? virtualPath.nsPerItem / kernel.nsPerItem : 0)
+            << (kernel.checksum == virtualPath.checksum ? "" : "  (RESULTS DIFFER)") << endl;
+        cout << oss.str();
+    }
+}
+
+static void usage()
+{
+    cout << "usage: kontagion-microbench [--candidates N] [--queries N] [--seed N] [--dirt-sweep]" << endl
+         << "  --candidates N  dirt piles scanned per query (default 64)" << endl
+         << "  --queries N     query points per round (default 200000)" << endl
+         << "  --seed N        seed for the positions (default 1)" << endl
+         << "  --dirt-sweep    time move checks and ticks against the amount of dirt" << endl;
+}
+
+  // Scatters extra dirt piles evenly over the dish
+static void addDirt(StudentWorld& world, RandomStream& random, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        double dx, dy;
+        polarOffset(random.nextInt(0, 359), random.nextInt(0, VIEW_RADIUS - SPRITE_WIDTH), dx, dy);
+        world.addActor(new DirtPile(&world, VIEW_WIDTH / 2 + dx, VIEW_HEIGHT / 2 + dy));
+    }
+}
+
+  // A level 1 world with extra dirt on top of its own, checked at random
+  // points the way a bacterium checks its next step, then ticked with no
+  // player input.  With the occupancy mask a check should cost the same
+  // however much dirt there is, and a tick should grow only with the dirt
+  // the bacteria actually bump into.
+static int dirtSweep(uint64_t seed, int numQueries)
+{
+    const int EXTRA_DIRT[] = { 0, 100, 200, 400, 800, 1600 };
+    const int TICKS = 2000;
+
+    cout << "dirt sweep: level 1 plus extra dirt, " << numQueries << " move checks, "
+         << TICKS << " ticks with no input" << endl;
+    for (int extra : EXTRA_DIRT)
+    {
+        HeadlessController controller;
+        StudentWorld world("", seed);
+        world.setController(&controller);
+        RandomStream random(seed);
+        if (world.init() != GWSTATUS_CONTINUE_GAME)
+            return 1;
+        addDirt(world, random, extra);
+        int dirt = world.actorCount(ACTOR_DIRT);
+
+        vector<double> qx(numQueries);
+        vector<double> qy(numQueries);
+        for (int q = 0; q < numQueries; q++)
+        {
+            double dx, dy;
+            polarOffset(random.nextInt(0, 359), random.nextInt(0, VIEW_RADIUS), dx, dy);
+            qx[q] = VIEW_WIDTH / 2 + dx;
+            qy[q] = VIEW_HEIGHT / 2 + dy;
+        }
+        Timing check = timeIt(numQueries, [&]() {
+            long sum = 0;
+            for (int q = 0; q < numQueries; q++)
+                sum += world.checkForMovePossible(qx[q], qy[q]);
+            return sum;
+        });
+
+          // A death restarts the level with the same extra dirt; only moves are timed
+        double seconds = 0;
+        for (int t = 0; t < TICKS; t++)
+        {
+            auto start = chrono::steady_clock::now();
+            int status = world.move();
+            seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            world.submitSounds();
+            if (status != GWSTATUS_CONTINUE_GAME)
+            {
+                world.cleanUp();
+                if (world.init() != GWSTATUS_CONTINUE_GAME)
+                    return 1;
+                addDirt(world, random, extra);
+            }
+        }
+        world.cleanUp();
+
+        ostringstream oss;
+        oss << "dirt " << dirt
+            << ": move check " << check.nsPerItem << " ns"
+            << " (" << check.checksum << " of " << numQueries << " free)"
+            << "  tick " << seconds / TICKS * 1e6 << " us" << endl;
+        cout << oss.str();
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int numCandidates = 64;
+    int numQueries = 200000;
+    uint64_t seed = 1;
+    bool sweepDirt = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--candidates" && i + 1 < argc)
+            numCandidates = max(1, atoi(argv[++i]));
+        else if (arg == "--queries" && i + 1 < argc)
+            numQueries = max(1, atoi(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--dirt-sweep")
+            sweepDirt = true;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if (sweepDirt)
+        return dirtSweep(seed, numQueries);
+
+      // Candidates are real DirtPiles scattered over a neighbourhood about the
+      // size of the cells a grid query visits, so a fair share of them hit.
+    StudentWorld world("", seed);
+    RandomStream random(seed);
+    Candidates c;
+    for (int i = 0; i < numCandidates; i++)
+    {
+        double x = random.nextInt(0, 4 * SPRITE_WIDTH);
+        double y = random.nextInt(0, 4 * SPRITE_WIDTH);
+        c.xs.push_back(x);
+        c.ys.push_back(y);
+        c.actors.push_back(new DirtPile(&world, x, y));
+    }
+    vector<double> qx(numQueries);
+    vector<double> qy(numQueries);
+    for (int q = 0; q < numQueries; q++)
+    {
+        qx[q] = random.nextInt(0, 4 * SPRITE_WIDTH * 64) / 64.0;
+        qy[q] = random.nextInt(0, 4 * SPRITE_WIDTH * 64) / 64.0;
+    }
+
+    const double radius = SPRITE_WIDTH / 2;
+    const double radius2 = radius * radius;
+    long perRound = long(numCandidates) * numQueries;
+    vector<int> hits(numCandidates);
+
+    cout << "distance kernels: " << distanceKernelName()
+         << "  candidates: " << numCandidates
+         << "  queries: " << numQueries << "  (ns per candidate)" << endl;
+
+      // first hit, as checkForMovePossible and findDamageable ask
+    Timing kernel = timeIt(perRound, [&]() {
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+            sum += firstWithinRadius(c.xs.data(), c.ys.data(), numCandidates, qx[q], qy[q], radius2);
+        return sum;
+    });
+    Timing virtualPath = timeIt(perRound, [&]() {
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            int found = -1;
+            for (int i = 0; i < numCandidates; i++)
+            {
+                if (c.actors[i]->isDamageable() && c.actors[i]->doesOverLap(qx[q], qy[q], radius))
+                {
+                    found = i;
+                    break;
+                }
+            }
+            sum += found;
+        }
+        return sum;
+    });
+    report("first within radius", kernel, virtualPath);
+
+      // every hit
+    kernel = timeIt(perRound, [&]() {
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            int n = filterWithinRadius(c.xs.data(), c.ys.data(), numCandidates, qx[q], qy[q], radius2, hits.data());
+            for (int i = 0; i < n; i++)
+                sum += hits[i];
+        }
+        return sum;
+    });
+    virtualPath = timeIt(perRound, [&]() {
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            for (int i = 0; i < numCandidates; i++)
+            {
+                if (c.actors[i]->isDamageable() && c.actors[i]->doesOverLap(qx[q], qy[q], radius))
+                    sum += i;
+            }
+        }
+        return sum;
+    });
+    report("filter within radius", kernel, virtualPath);
+
+      // nearest, as getAngleToNearestNearbyEdible asks, with the sqrt it used to take
+    const double searchRadius = 2 * SPRITE_WIDTH;
+    kernel = timeIt(perRound, [&]() {
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            double best2 = searchRadius * searchRadius;
+            sum += nearestWithinRadius(c.xs.data(), c.ys.data(), numCandidates, qx[q], qy[q], best2);
+        }
+        return sum;
+    });
+    virtualPath = timeIt(perRound, [&]() {
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            double shortest = searchRadius;
+            int best = -1;
+            for (int i = 0; i < numCandidates; i++)
+            {
+                double dx = c.actors[i]->getX() - qx[q];
+                double dy = c.actors[i]->getY() - qy[q];
+                double d = sqrt(dx * dx + dy * dy);
+                if (d <= shortest)
+                {
+                    shortest = d;
+                    best = i;
+                }
+            }
+            sum += best;
+        }
+        return sum;
+    });
+    report("nearest within radius", kernel, virtualPath);
+
+      // One bacterium-sized step per move, in a direction that changes every
+      // move.  Both paths round the result to 16.16, so they should agree.
+    vector<int> directions(numQueries);
+    for (int q = 0; q < numQueries; q++)
+        directions[q] = random.nextInt(0, 359);
+    cout << "movement: " << numQueries << " moves  (ns per move)" << endl;
+    Timing table = timeIt(numQueries, [&]() {
+        Fixed x = toFixed(VIEW_WIDTH / 2);
+        Fixed y = toFixed(VIEW_HEIGHT / 2);
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            stepFixed(x, y, directions[q], 3);
+            sum += x ^ y;
+        }
+        return sum;
+    });
+    Timing trig = timeIt(numQueries, [&]() {
+        Fixed x = toFixed(VIEW_WIDTH / 2);
+        Fixed y = toFixed(VIEW_HEIGHT / 2);
+        long sum = 0;
+        for (int q = 0; q < numQueries; q++)
+        {
+            const double PI = 4 * atan(1);      // what moveAngle did before the table
+            x = toFixed(fromFixed(x) + 3 * cos(directions[q]*1.0 / 360 * 2 * PI));
+            y = toFixed(fromFixed(y) + 3 * sin(directions[q]*1.0 / 360 * 2 * PI));
+            sum += x ^ y;
+        }
+        return sum;
+    });
+    report("step in direction", table, trig, "table", "cos/sin");
+
+    for (int i = 0; i < numCandidates; i++)
+        delete c.actors[i];
+    return 0;
+}